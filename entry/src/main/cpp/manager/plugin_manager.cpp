@@ -16,6 +16,7 @@
 #include "plugin_manager.h"
 
 #include <ace/xcomponent/native_interface_xcomponent.h>
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <hilog/log.h>
@@ -24,6 +25,9 @@
 #include "arkui/native_node_napi.h"
 #include "arkui/native_interface.h"
 #include "../common/common.h"
+#include "render/egl_device.h"
+#include "render/program_cache.h"
+#include "render/self_test.h"
 
 #include <resourcemanager/ohresmgr.h>
 
@@ -31,14 +35,41 @@
 #define XC_WIDTH 300
 #define XC_HEIGHT 300
 #define ARG_CNT 2
+#define BENCHMARK_FRAME_COUNT 120
+#define BENCHMARK_SHAPE_COUNT 1000
+#define BENCHMARK_MAX_FRAMES 600
+#define BENCHMARK_MAX_SHAPES 10000
 
 namespace NativeXComponentSample {
 PluginManager PluginManager::pluginManager_;
 OH_NativeXComponent_Callback PluginManager::callback_;
 static ArkUI_NativeNodeAPI_1* nodeAPI;
-ArkUI_NodeHandle xc;
-int32_t PluginManager::hasDraw_ = 0;
-int32_t PluginManager::hasChangeColor_ = 0;
+std::atomic<int32_t> PluginManager::hasDraw_(0);
+std::atomic<int32_t> PluginManager::hasChangeColor_(0);
+
+static const char* VERTEX_FORMAT_NAMES[VERTEX_FORMAT_COUNT] = {"FLOAT32", "HALF_FLOAT", "NORM_INT16"};
+
+static uint32_t value2Uint32(napi_env env, napi_value value, uint32_t defaultValue)
+{
+    napi_valuetype type = napi_undefined;
+    uint32_t result = 0;
+    if ((napi_typeof(env, value, &type) != napi_ok) || (type != napi_number) ||
+        (napi_get_value_uint32(env, value, &result) != napi_ok) || (result == 0)) {
+        return defaultValue;
+    }
+    return result;
+}
+
+static void RejectBenchmark(napi_env env, napi_deferred deferred, const char* message)
+{
+    napi_value text = nullptr;
+    napi_value error = nullptr;
+    if ((napi_create_string_utf8(env, message, NAPI_AUTO_LENGTH, &text) != napi_ok) ||
+        (napi_create_error(env, nullptr, text, &error) != napi_ok)) {
+        napi_get_undefined(env, &error);
+    }
+    napi_reject_deferred(env, deferred, error);
+}
 
 static std::string value2String(napi_env env, napi_value value)
 {
@@ -54,13 +85,13 @@ napi_value PluginManager::GetXComponentStatus(napi_env env, napi_callback_info i
     napi_value hasDraw;
     napi_value hasChangeColor;
 
-    napi_status ret = napi_create_int32(env, hasDraw_, &(hasDraw));
+    napi_status ret = napi_create_int32(env, hasDraw_.load(), &(hasDraw));
     if (ret != napi_ok) {
         OH_LOG_Print(
             LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GetXComponentStatus", "napi_create_int32 hasDraw_ error");
         return nullptr;
     }
-    ret = napi_create_int32(env, hasChangeColor_, &(hasChangeColor));
+    ret = napi_create_int32(env, hasChangeColor_.load(), &(hasChangeColor));
     if (ret != napi_ok) {
         OH_LOG_Print(
             LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GetXComponentStatus", "napi_create_int32 hasChangeColor_ error");
@@ -95,19 +126,196 @@ napi_value PluginManager::NapiDrawPattern(napi_env env, napi_callback_info info)
         OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "NapiDrawPattern: env or info is null");
         return nullptr;
     }
+    size_t argCnt = 1;
+    napi_value args[1] = { nullptr };
     napi_value thisArg;
-    if (napi_get_cb_info(env, info, nullptr, nullptr, &thisArg, nullptr) != napi_ok) {
+    if (napi_get_cb_info(env, info, &argCnt, args, &thisArg, nullptr) != napi_ok) {
         OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "NapiDrawPattern: napi_get_cb_info fail");
         return nullptr;
     }
 
     auto *pluginManger = PluginManager::GetInstance();
-    pluginManger->eglcore_->Draw(hasDraw_);
-    OH_LOG_Print(LOG_APP, LOG_INFO, LOG_PRINT_DOMAIN, "PluginManager", "render->eglCore_->Draw() executed");
+    // An XComponent id selects one surface; without it every surface draws.
+    uint32_t surface = 0;
+    napi_valuetype argType = napi_undefined;
+    if ((argCnt >= 1) && (napi_typeof(env, args[0], &argType) == napi_ok) && (argType == napi_string)) {
+        std::string id = value2String(env, args[0]);
+        surface = pluginManger->FindSurface(pluginManger->FindXComponent(id));
+        if (surface == 0) {
+            OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager",
+                         "NapiDrawPattern: unknown id %{public}s", id.c_str());
+            return nullptr;
+        }
+    }
+    RenderCommand command = {RenderCommandType::DRAW_PATTERN, surface, nullptr, 0, 0};
+    // Taps faster than the render thread can draw collapse into one frame.
+    if (!pluginManger->renderThread_->PostCoalesced(command)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "NapiDrawPattern: post draw failed");
+        return nullptr;
+    }
+    OH_LOG_Print(LOG_APP, LOG_INFO, LOG_PRINT_DOMAIN, "PluginManager", "draw command posted to render thread");
     
     return nullptr;
 }
 
+napi_value PluginManager::NapiSetCacheDir(napi_env env, napi_callback_info info)
+{
+    if ((env == nullptr) || (info == nullptr)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "NapiSetCacheDir: env or info is null");
+        return nullptr;
+    }
+    size_t argCnt = 1;
+    napi_value args[1] = { nullptr };
+    if (napi_get_cb_info(env, info, &argCnt, args, nullptr, nullptr) != napi_ok) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "NapiSetCacheDir: napi_get_cb_info fail");
+        return nullptr;
+    }
+    napi_valuetype argType = napi_undefined;
+    if ((argCnt < 1) || (napi_typeof(env, args[0], &argType) != napi_ok) || (argType != napi_string)) {
+        napi_throw_type_error(env, NULL, "Wrong arguments");
+        return nullptr;
+    }
+    // Program binaries are written here; must be set before the first surface to help startup.
+    ProgramCache::Instance().SetDirectory(value2String(env, args[0]));
+    return nullptr;
+}
+
+napi_value PluginManager::NapiBenchmarkShapes(napi_env env, napi_callback_info info)
+{
+    if ((env == nullptr) || (info == nullptr)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "NapiBenchmarkShapes: env or info is null");
+        return nullptr;
+    }
+    size_t argCnt = 2;
+    napi_value args[2] = { nullptr, nullptr };
+    if (napi_get_cb_info(env, info, &argCnt, args, nullptr, nullptr) != napi_ok) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager",
+                     "NapiBenchmarkShapes: napi_get_cb_info fail");
+        return nullptr;
+    }
+    uint32_t frames = (argCnt >= 1) ? value2Uint32(env, args[0], BENCHMARK_FRAME_COUNT) : BENCHMARK_FRAME_COUNT;
+    uint32_t shapes = (argCnt >= ARG_CNT) ? value2Uint32(env, args[1], BENCHMARK_SHAPE_COUNT) : BENCHMARK_SHAPE_COUNT;
+    // Bounded so one call cannot hold the render thread for long or outgrow a frame's batch.
+    frames = std::min<uint32_t>(frames, BENCHMARK_MAX_FRAMES);
+    shapes = std::min<uint32_t>(shapes, BENCHMARK_MAX_SHAPES);
+
+    napi_deferred deferred = nullptr;
+    napi_value promise = nullptr;
+    if (napi_create_promise(env, &deferred, &promise) != napi_ok) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "NapiBenchmarkShapes: create promise fail");
+        return nullptr;
+    }
+    auto *pluginManger = PluginManager::GetInstance();
+    auto *request = new BenchmarkRequest();
+    request->deferred = deferred;
+    BenchmarkRequest *idle = nullptr;
+    if (!pluginManger->benchmark_.compare_exchange_strong(idle, request)) {
+        delete request;
+        RejectBenchmark(env, deferred, "benchmark already running");
+        return promise;
+    }
+
+    // The render thread runs every format and hands the results back to this thread, so
+    // the caller is never blocked while frames are presented.
+    napi_value name = nullptr;
+    RenderCommand command = {RenderCommandType::BENCHMARK_SHAPES, 0, nullptr, frames, shapes};
+    if ((napi_create_string_utf8(env, "benchmarkShapes", NAPI_AUTO_LENGTH, &name) != napi_ok) ||
+        (napi_create_threadsafe_function(env, nullptr, nullptr, name, 0, 1, nullptr, nullptr, nullptr,
+                                         OnBenchmarkComplete, &request->complete) != napi_ok)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "NapiBenchmarkShapes: napi error");
+    } else if (!pluginManger->renderThread_->Post(command)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "NapiBenchmarkShapes: post failed");
+        napi_release_threadsafe_function(request->complete, napi_tsfn_release);
+    } else {
+        return promise;
+    }
+    pluginManger->benchmark_.store(nullptr);
+    delete request;
+    RejectBenchmark(env, deferred, "benchmark could not be started");
+    return promise;
+}
+
+napi_value PluginManager::NapiRunSelfTests(napi_env env, napi_callback_info info)
+{
+    if ((env == nullptr) || (info == nullptr)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "NapiRunSelfTests: env or info is null");
+        return nullptr;
+    }
+    size_t argCnt = 1;
+    napi_value args[1] = { nullptr };
+    if (napi_get_cb_info(env, info, &argCnt, args, nullptr, nullptr) != napi_ok) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "NapiRunSelfTests: napi_get_cb_info fail");
+        return nullptr;
+    }
+    // Without a group name every check runs.
+    std::string group;
+    napi_valuetype argType = napi_undefined;
+    if ((argCnt >= 1) && (napi_typeof(env, args[0], &argType) == napi_ok) && (argType == napi_string)) {
+        group = value2String(env, args[0]);
+    }
+    std::vector<std::string> failures = SelfTest::Run(group);
+
+    napi_value results;
+    if (napi_create_array_with_length(env, failures.size(), &results) != napi_ok) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < failures.size(); ++i) {
+        napi_value failure;
+        if (napi_create_string_utf8(env, failures[i].c_str(), NAPI_AUTO_LENGTH, &failure) != napi_ok) {
+            OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "NapiRunSelfTests: napi error");
+            return nullptr;
+        }
+        napi_set_element(env, results, static_cast<uint32_t>(i), failure);
+    }
+    return results;
+}
+
+void PluginManager::OnBenchmarkComplete(napi_env env, napi_value callback, void* context, void* data)
+{
+    auto *request = static_cast<BenchmarkRequest*>(data);
+    // The next benchmark may start as soon as this one is settled.
+    PluginManager::GetInstance()->benchmark_.store(nullptr);
+    if (env == nullptr) {
+        // The environment is going away; nothing is left to settle.
+        delete request;
+        return;
+    }
+    if (request->count == 0) {
+        RejectBenchmark(env, request->deferred, "no visible surface");
+        delete request;
+        return;
+    }
+    napi_value results;
+    if (napi_create_array_with_length(env, request->count, &results) != napi_ok) {
+        RejectBenchmark(env, request->deferred, "napi error");
+        delete request;
+        return;
+    }
+    for (size_t i = 0; i < request->count; ++i) {
+        const ShapeBenchmark& benchmark = request->results[i];
+        napi_value obj;
+        napi_value format;
+        napi_value bytes;
+        napi_value ms;
+        if ((napi_create_object(env, &obj) != napi_ok) ||
+            (napi_create_string_utf8(env, VERTEX_FORMAT_NAMES[static_cast<size_t>(benchmark.format)],
+                                     NAPI_AUTO_LENGTH, &format) != napi_ok) ||
+            (napi_create_int64(env, static_cast<int64_t>(benchmark.bytesPerFrame), &bytes) != napi_ok) ||
+            (napi_create_double(env, benchmark.msPerFrame, &ms) != napi_ok)) {
+            OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "OnBenchmarkComplete: napi error");
+            RejectBenchmark(env, request->deferred, "napi error");
+            delete request;
+            return;
+        }
+        napi_set_named_property(env, obj, "format", format);
+        napi_set_named_property(env, obj, "bytesPerFrame", bytes);
+        napi_set_named_property(env, obj, "msPerFrame", ms);
+        napi_set_element(env, results, static_cast<uint32_t>(i), obj);
+    }
+    napi_resolve_deferred(env, request->deferred, results);
+    delete request;
+}
+
 void OnSurfaceCreatedCB(OH_NativeXComponent* component, void* window)
 {
     OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "XComponent_Native", "OnSurfaceCreatedCB");
@@ -169,7 +377,8 @@ void DispatchTouchEventCB(OH_NativeXComponent* component, void* window)
 }
 PluginManager::PluginManager()
 {
-    eglcore_ = new EGLCore();
+    renderThread_ = new RenderThread([this](const RenderCommand& command) { OnRenderCommand(command); });
+    renderThread_->Start();
     callback_.OnSurfaceCreated = OnSurfaceCreatedCB;
     callback_.OnSurfaceChanged = OnSurfaceChangedCB;
     callback_.OnSurfaceDestroyed = OnSurfaceDestroyedCB;
@@ -180,22 +389,94 @@ PluginManager::~PluginManager()
 {
     OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "Callback", "~PluginManager");
     nativeXComponentMap_.clear();
-    if (eglcore_ != nullptr) {
-        delete eglcore_;
-        eglcore_ = nullptr;
+    surfaceIds_.clear();
+    if (renderThread_ != nullptr) {
+        // GL objects can only be deleted where the context is current, so the render thread
+        // releases every core and lets go of the context before it is joined.
+        RenderCommand command = {RenderCommandType::SURFACE_REMOVED, 0, nullptr, 0, 0};
+        uint64_t ticket = 0;
+        if (renderThread_->PostWait(command, &ticket)) {
+            renderThread_->WaitIdle(ticket);
         }
+        delete renderThread_;
+        renderThread_ = nullptr;
+    }
+    // Only left when the render thread had already stopped. The context is not current on
+    // this thread, so no GL calls here; eglTerminate reclaims what these cores still hold.
+    for (auto iter = surfaces_.begin(); iter != surfaces_.end(); ++iter) {
+        delete iter->second;
+    }
+    surfaces_.clear();
+    EGLCore::AbandonSharedResources();
+    renderContext_.Destroy();
+    EGLDevice::Instance().Shutdown();
+}
 
-    for (auto iter = pluginManagerMap_.begin(); iter != pluginManagerMap_.end(); ++iter) {
-        if (iter->second != nullptr) {
-            delete iter->second;
-            iter->second = nullptr;
-        }
+std::string PluginManager::MakeXComponentId(const std::string& tag) const
+{
+    // Every embedded canvas needs its own id; repeated tags get a numeric suffix.
+    std::string id = tag;
+    for (size_t suffix = 1; nativeXComponentMap_.find(id) != nativeXComponentMap_.end(); ++suffix) {
+        id = tag + "_" + std::to_string(suffix);
+    }
+    return id;
+}
+
+void PluginManager::RegisterXComponent(const std::string& id, OH_NativeXComponent* component)
+{
+    uint32_t surface = nextSurfaceId_++;
+    nativeXComponentMap_[id] = component;
+    surfaceIds_[component] = surface;
+    if (!renderThread_->AcquireSurfaceSlot(surface)) {
+        OH_LOG_Print(LOG_APP, LOG_INFO, LOG_PRINT_DOMAIN, "PluginManager", "surface %{public}u resizes uncoalesced",
+                     surface);
+    }
+}
+
+void PluginManager::UnregisterXComponent(const std::string& id)
+{
+    auto iter = nativeXComponentMap_.find(id);
+    if (iter == nativeXComponentMap_.end()) {
+        return;
     }
-    pluginManagerMap_.clear();
+    // Frees the id for reuse and drops the pointer before the node behind it is gone.
+    uint32_t surface = FindSurface(iter->second);
+    surfaceIds_.erase(iter->second);
+    nativeXComponentMap_.erase(iter);
+    if (surface == 0) {
+        return;
+    }
+    // The core holds GPU memory until released; this must not be lost on a full queue.
+    RenderCommand command = {RenderCommandType::SURFACE_REMOVED, surface, nullptr, 0, 0};
+    renderThread_->PostWait(command);
 }
 
-ArkUI_NodeHandle CreateNodeHandle(const std::string &tag)
+uint32_t PluginManager::FindSurface(OH_NativeXComponent* component) const
 {
+    auto iter = surfaceIds_.find(component);
+    return (iter != surfaceIds_.end()) ? iter->second : 0;
+}
+
+OH_NativeXComponent* PluginManager::FindXComponent(const std::string& id) const
+{
+    auto iter = nativeXComponentMap_.find(id);
+    return (iter != nativeXComponentMap_.end()) ? iter->second : nullptr;
+}
+
+/**
+ * NodeContent user data: the tag from ArkTS and, while attached, the nodes built for it
+ * and the XComponent id they registered, so detaching can tear them down again.
+ */
+struct NodeContentData {
+    std::string tag;
+    std::string id;
+    ArkUI_NodeHandle column = nullptr;
+    ArkUI_NodeHandle xcomponent = nullptr;
+};
+
+ArkUI_NodeHandle CreateNodeHandle(NodeContentData &data)
+{
+    const std::string &tag = data.tag;
     ArkUI_NodeHandle column = nodeAPI->createNode(ARKUI_NODE_COLUMN);
     ArkUI_NumberValue value[] = {480};
     ArkUI_NumberValue value1[] = {{.u32 = 15}, {.f32 = 15}};
@@ -204,10 +485,15 @@ ArkUI_NodeHandle CreateNodeHandle(const std::string &tag)
     nodeAPI->setAttribute(column, NODE_WIDTH, &item);
     value[0].f32 = COLUMN_MARGIN;
     nodeAPI->setAttribute(column, NODE_MARGIN, &item);
-    xc = nodeAPI->createNode(ARKUI_NODE_XCOMPONENT);
+    ArkUI_NodeHandle xc = nodeAPI->createNode(ARKUI_NODE_XCOMPONENT);
+    data.column = column;
+    data.xcomponent = xc;
     value[0].u32 = ARKUI_XCOMPONENT_TYPE_SURFACE;
     nodeAPI->setAttribute(xc, NODE_XCOMPONENT_TYPE, &item);
-    nodeAPI->setAttribute(xc, NODE_XCOMPONENT_ID, &item);
+    auto *pluginManager = PluginManager::GetInstance();
+    std::string id = pluginManager->MakeXComponentId(tag);
+    ArkUI_AttributeItem idItem = {nullptr, 0, id.c_str()};
+    nodeAPI->setAttribute(xc, NODE_XCOMPONENT_ID, &idItem);
     nodeAPI->setAttribute(xc, NODE_XCOMPONENT_SURFACE_SIZE, &item1);
     ArkUI_NumberValue focusable[] = {1};
     focusable[0].i32 = 1;
@@ -219,8 +505,7 @@ ArkUI_NodeHandle CreateNodeHandle(const std::string &tag)
     nodeAPI->setAttribute(xc, NODE_WIDTH, &itemSize);
     valueSize[0].f32 = XC_HEIGHT;
     nodeAPI->setAttribute(xc, NODE_HEIGHT, &itemSize);
-    ArkUI_AttributeItem item2 = {value, 1, "ndkxcomponent"};
-    nodeAPI->setAttribute(xc, NODE_ID, &item2);
+    nodeAPI->setAttribute(xc, NODE_ID, &idItem);
     
     auto *nativeXComponent = OH_NativeXComponent_GetNativeXComponent(xc);
     if (!nativeXComponent) {
@@ -229,6 +514,8 @@ ArkUI_NodeHandle CreateNodeHandle(const std::string &tag)
     }
     OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "GetNativeXComponent success");
     OH_NativeXComponent_RegisterCallback(nativeXComponent, &PluginManager::callback_);
+    pluginManager->RegisterXComponent(id, nativeXComponent);
+    data.id = id;
     auto typeRet = nodeAPI->getAttribute(xc, NODE_XCOMPONENT_TYPE);
     OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "xcomponent type: %{public}d",
                  typeRet->value[0].i32);
@@ -239,6 +526,23 @@ ArkUI_NodeHandle CreateNodeHandle(const std::string &tag)
     return column;
 }
 
+void DisposeNodeHandle(ArkUI_NodeContentHandle handle, NodeContentData &data)
+{
+    if (data.column == nullptr) {
+        return;
+    }
+    OH_ArkUI_NodeContent_RemoveNode(handle, data.column);
+    nodeAPI->removeChild(data.column, data.xcomponent);
+    nodeAPI->disposeNode(data.xcomponent);
+    nodeAPI->disposeNode(data.column);
+    data.column = nullptr;
+    data.xcomponent = nullptr;
+    if (!data.id.empty()) {
+        PluginManager::GetInstance()->UnregisterXComponent(data.id);
+        data.id.clear();
+    }
+}
+
 napi_value PluginManager::createNativeNode(napi_env env, napi_callback_info info)
 {
     if ((env == nullptr) || (info == nullptr)) {
@@ -261,7 +565,10 @@ napi_value PluginManager::createNativeNode(napi_env env, napi_callback_info info
     );
     std::string tag = value2String(env, args[1]);
     OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "tag=%{public}s", tag.c_str());
-    int32_t ret = OH_ArkUI_NodeContent_SetUserData(nodeContentHandle_, new std::string(tag));
+    // Kept for the NodeContent's lifetime: it is attached and detached again as its page is shown and hidden.
+    NodeContentData *data = new NodeContentData();
+    data->tag = tag;
+    int32_t ret = OH_ArkUI_NodeContent_SetUserData(nodeContentHandle_, data);
     if (ret != ARKUI_ERROR_CODE_NO_ERROR) {
         OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "setUserData failed error=%{public}d", ret);
     }
@@ -270,17 +577,19 @@ napi_value PluginManager::createNativeNode(napi_env env, napi_callback_info info
                      "CreateNativeNode tag=%{public}s", tag.c_str());
         auto nodeContentEvent = [](ArkUI_NodeContentEvent *event) {
             ArkUI_NodeContentHandle handle = OH_ArkUI_NodeContentEvent_GetNodeContentHandle(event);
-            std::string *userDate = reinterpret_cast<std::string*>(OH_ArkUI_NodeContent_GetUserData(handle));
-            if (OH_ArkUI_NodeContentEvent_GetEventType(event) == NODE_CONTENT_EVENT_ON_ATTACH_TO_WINDOW) {
-                ArkUI_NodeHandle testNode;
-                if (userDate) {
-                    testNode = CreateNodeHandle(*userDate);
-                    delete userDate;
-                    userDate = nullptr;
-                } else {
-                    testNode = CreateNodeHandle("noUserData");
-                }
+            NodeContentData *userDate = reinterpret_cast<NodeContentData*>(OH_ArkUI_NodeContent_GetUserData(handle));
+            if (userDate == nullptr) {
+                userDate = new NodeContentData();
+                userDate->tag = "noUserData";
+                OH_ArkUI_NodeContent_SetUserData(handle, userDate);
+            }
+            ArkUI_NodeContentEventType type = OH_ArkUI_NodeContentEvent_GetEventType(event);
+            if ((type == NODE_CONTENT_EVENT_ON_ATTACH_TO_WINDOW) && (userDate->column == nullptr)) {
+                ArkUI_NodeHandle testNode = CreateNodeHandle(*userDate);
                 OH_ArkUI_NodeContent_AddNode(handle, testNode);
+            } else if (type == NODE_CONTENT_EVENT_ON_DETACH_FROM_WINDOW) {
+                // Disposing the nodes ends the XComponent, so its id and pointer must go too.
+                DisposeNodeHandle(handle, *userDate);
             }
         };
         OH_ArkUI_NodeContent_RegisterCallback(nodeContentHandle_, nodeContentEvent);
@@ -295,16 +604,29 @@ void PluginManager::OnSurfaceCreated(OH_NativeXComponent* component, void* windo
     char idStr[OH_XCOMPONENT_ID_LEN_MAX + 1] = {};
     uint64_t idSize = OH_XCOMPONENT_ID_LEN_MAX + 1;
     ret = OH_NativeXComponent_GetXComponentId(component, idStr, &idSize);
-    ret = OH_NativeXComponent_GetXComponentSize(component, window, &width_, &height_);
+    uint64_t width = 0;
+    uint64_t height = 0;
+    ret = OH_NativeXComponent_GetXComponentSize(component, window, &width, &height);
     if (ret == OH_NATIVEXCOMPONENT_RESULT_SUCCESS) {
-        eglcore_->EglContextInit(window, width_, height_);
-        eglcore_->Background();
+        // Sizes reported for the previous window must not be applied to this one.
+        RenderCommand command = {RenderCommandType::SURFACE_CREATED, FindSurface(component), window, width, height};
+        renderThread_->BreakLatest(command.surface);
+        // A dropped create would leave the surface black until it is recreated.
+        renderThread_->PostWait(command);
     }
 }
 
 void PluginManager::OnSurfaceDestroyed(OH_NativeXComponent* component, void* window)
 {
     OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "XComponent_Native", "PluginManager::OnSurfaceDestroyed");
+    // The window is only valid until this callback returns, so wait for the render thread to let go of it.
+    // Dropping the command on a full queue would leave the render thread drawing into a dead window.
+    RenderCommand command = {RenderCommandType::SURFACE_DESTROYED, FindSurface(component), window, 0, 0};
+    renderThread_->BreakLatest(command.surface);
+    uint64_t ticket = 0;
+    if (renderThread_->PostWait(command, &ticket)) {
+        renderThread_->WaitIdle(ticket);
+    }
 }
 
 void PluginManager::DispatchTouchEvent(OH_NativeXComponent* component, void* window)
@@ -323,8 +645,10 @@ void PluginManager::DispatchTouchEvent(OH_NativeXComponent* component, void* win
                      "type=%{public}d, force=%{public}f, tiltX=%{public}f, tiltY=%{public}f, toolType=%{public}d",
                      touchEvent_.x, touchEvent_.y, touchEvent_.screenX,
                      touchEvent_.screenY, touchEvent_.type, touchEvent_.force, tiltX, tiltY, toolType);
-        if (touchEvent_.type == OH_NativeXComponent_TouchEventType::OH_NATIVEXCOMPONENT_UP)
-            eglcore_->ChangeColor(hasChangeColor_);
+        if (touchEvent_.type == OH_NativeXComponent_TouchEventType::OH_NATIVEXCOMPONENT_UP) {
+            RenderCommand command = {RenderCommandType::CHANGE_COLOR, FindSurface(component), window, 0, 0};
+            renderThread_->PostCoalesced(command);
+        }
     } else {
         OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "XComponent_Native", "touch fail");
     }
@@ -332,8 +656,200 @@ void PluginManager::DispatchTouchEvent(OH_NativeXComponent* component, void* win
 void PluginManager::OnSurfaceChanged(OH_NativeXComponent* component, void* window)
 {
     int32_t ret = OH_NativeXComponent_GetXComponentSize(component, window, &width_, &height_);
-    OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "XComponent_Native",
-                 "OnSurfaceChanged ret=%{public}d width=%{public}lu, height=%{public}lu", ret, width_, height_);
+    if (ret != OH_NATIVEXCOMPONENT_RESULT_SUCCESS) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "XComponent_Native",
+                     "OnSurfaceChanged: get size failed ret=%{public}d", ret);
+        return;
+    }
+    // A resize animation reports a size per UI frame; the render thread applies only the
+    // newest one still pending, and presenting it is paced by the swap.
+    RenderCommand command = {RenderCommandType::SURFACE_CHANGED, FindSurface(component), window, width_, height_};
+    renderThread_->PostLatest(command);
+}
+
+void PluginManager::CreateSurface(const RenderCommand& command)
+{
+    if (command.surface == 0) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "surface of unknown XComponent");
+        return;
+    }
+    // A known XComponent coming back (e.g. its tab shown again) kept its context and GPU
+    // resources, so it only needs a new EGLSurface.
+    auto iter = surfaces_.find(command.surface);
+    if (iter != surfaces_.end()) {
+        if (!iter->second->AttachSurface(command.window, command.width, command.height)) {
+            OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "surface resume failed");
+            return;
+        }
+        // Requests made while it was hidden are only reported now that they are on screen.
+        int hasDraw = hasDraw_.load();
+        int hasChangeColor = hasChangeColor_.load();
+        iter->second->TakeDeferred(hasDraw, hasChangeColor);
+        hasDraw_.store(hasDraw);
+        hasChangeColor_.store(hasChangeColor);
+        return;
+    }
+    if (!renderContext_.Init()) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "render context init failed");
+        return;
+    }
+    EGLCore *eglcore = new EGLCore();
+    if (!eglcore->EglContextInit(&renderContext_, command.window, command.width, command.height)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "surface init failed");
+        eglcore->Release();
+        delete eglcore;
+        return;
+    }
+    surfaces_[command.surface] = eglcore;
+    eglcore->Background();
+}
+
+void PluginManager::DestroySurface(uint32_t surface)
+{
+    auto iter = surfaces_.find(surface);
+    if (iter == surfaces_.end()) {
+        return;
+    }
+    // Only the window is gone; the context and the surface's resources are kept for its
+    // next OnSurfaceCreated.
+    iter->second->DetachSurface();
+}
+
+void PluginManager::RemoveSurface(uint32_t surface)
+{
+    if (surface == 0) {
+        // Shutdown: every core goes, and the context is left free for Destroy() on another thread.
+        for (auto iter = surfaces_.begin(); iter != surfaces_.end(); ++iter) {
+            renderThread_->ReleaseSurfaceSlot(iter->first);
+            iter->second->Release();
+            delete iter->second;
+        }
+        surfaces_.clear();
+        renderContext_.ReleaseCurrent();
+        return;
+    }
+    // Nothing is posted for the surface after SURFACE_REMOVED, so its slot is free for reuse.
+    renderThread_->ReleaseSurfaceSlot(surface);
+    auto iter = surfaces_.find(surface);
+    if (iter == surfaces_.end()) {
+        return;
+    }
+    // The XComponent will not come back, so its GPU resources go with it.
+    iter->second->Release();
+    delete iter->second;
+    surfaces_.erase(iter);
+}
+
+void PluginManager::BenchmarkShapes(uint32_t frames, uint32_t shapeCount)
+{
+    BenchmarkRequest *request = benchmark_.load();
+    if (request == nullptr) {
+        return;
+    }
+    // Any visible surface will do; the shapes are erased again afterwards.
+    auto iter = surfaces_.begin();
+    while ((iter != surfaces_.end()) && !iter->second->HasSurface()) {
+        ++iter;
+    }
+    if (iter == surfaces_.end()) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "benchmark: no visible surface");
+    }
+    for (size_t i = 0; (iter != surfaces_.end()) && (i < VERTEX_FORMAT_COUNT); ++i) {
+        ShapeBenchmark& result = request->results[request->count];
+        if (!iter->second->BenchmarkShapes(static_cast<VertexFormat>(i), frames, shapeCount, result)) {
+            continue;
+        }
+        OH_LOG_Print(LOG_APP, LOG_INFO, LOG_PRINT_DOMAIN, "PluginManager",
+                     "benchmark %{public}s: %{public}llu bytes/frame, %{public}.3f ms/frame",
+                     VERTEX_FORMAT_NAMES[i], static_cast<unsigned long long>(result.bytesPerFrame),
+                     result.msPerFrame);
+        ++request->count;
+    }
+    // The JS thread owns the request from here on.
+    napi_threadsafe_function complete = request->complete;
+    if (napi_call_threadsafe_function(complete, request, napi_tsfn_nonblocking) != napi_ok) {
+        // The promise can no longer be settled; at least let the next benchmark start.
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "benchmark: result not delivered");
+        benchmark_.store(nullptr);
+        delete request;
+    }
+    napi_release_threadsafe_function(complete, napi_tsfn_release);
+}
+
+void PluginManager::OnRenderCommand(const RenderCommand& command)
+{
+    switch (command.type) {
+        case RenderCommandType::SURFACE_CREATED:
+            CreateSurface(command);
+            break;
+        case RenderCommandType::SURFACE_CHANGED: {
+            auto iter = surfaces_.find(command.surface);
+            if ((iter != surfaces_.end()) && !iter->second->Resize(command.width, command.height)) {
+                OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "PluginManager", "surface resize failed");
+            }
+            break;
+        }
+        case RenderCommandType::SURFACE_DESTROYED:
+            DestroySurface(command.surface);
+            break;
+        case RenderCommandType::SURFACE_REMOVED:
+            RemoveSurface(command.surface);
+            break;
+        case RenderCommandType::DRAW_PATTERN: {
+            int hasDraw = hasDraw_.load();
+            for (auto iter = surfaces_.begin(); iter != surfaces_.end(); ++iter) {
+                if ((command.surface == 0) || (command.surface == iter->first)) {
+                    iter->second->Draw(hasDraw);
+                }
+            }
+            hasDraw_.store(hasDraw);
+            break;
+        }
+        case RenderCommandType::CHANGE_COLOR: {
+            auto iter = surfaces_.find(command.surface);
+            if (iter == surfaces_.end()) {
+                break;
+            }
+            int hasChangeColor = hasChangeColor_.load();
+            iter->second->ChangeColor(hasChangeColor);
+            hasChangeColor_.store(hasChangeColor);
+            break;
+        }
+        case RenderCommandType::RETRY_FRAME: {
+            auto iter = surfaces_.find(command.surface);
+            if (iter == surfaces_.end()) {
+                break;
+            }
+            int hasDraw = hasDraw_.load();
+            int hasChangeColor = hasChangeColor_.load();
+            iter->second->RetryFrame(hasDraw, hasChangeColor);
+            hasDraw_.store(hasDraw);
+            hasChangeColor_.store(hasChangeColor);
+            break;
+        }
+        case RenderCommandType::BENCHMARK_SHAPES:
+            BenchmarkShapes(static_cast<uint32_t>(command.width), static_cast<uint32_t>(command.height));
+            break;
+        default:
+            break;
+    }
+    RetryBlockedFrames();
+}
+
+void PluginManager::RetryBlockedFrames()
+{
+    // A frame blocked on the GPU keeps its changes pending; queue another attempt behind
+    // whatever else is waiting rather than spinning here. Not while stopping, where the
+    // queue is drained once and a busy GPU must not keep it alive.
+    if (!renderThread_->Running()) {
+        return;
+    }
+    for (auto iter = surfaces_.begin(); iter != surfaces_.end(); ++iter) {
+        if (iter->second->HasSurface() && iter->second->FrameBlocked()) {
+            RenderCommand retry = {RenderCommandType::RETRY_FRAME, iter->first, nullptr, 0, 0};
+            renderThread_->PostCoalesced(retry);
+        }
+    }
 }
 
 } // namespace NativeXComponentSample
@@ -16,6 +16,7 @@
 #define NATIVE_XCOMPONENT_PLUGIN_MANAGER_H
 
 #include <ace/xcomponent/native_interface_xcomponent.h>
+#include <atomic>
 #include <cstdint>
 #include <js_native_api.h>
 #include <js_native_api_types.h>
@@ -23,6 +24,8 @@
 #include <string>
 #include <unordered_map>
 #include "render/egl_core.h"
+#include "render/render_context.h"
+#include "render/render_thread.h"
 
 namespace NativeXComponentSample {
 class PluginManager {
@@ -39,6 +42,9 @@ public:
     static napi_value createNativeNode(napi_env env, napi_callback_info info);
     static napi_value GetXComponentStatus(napi_env env, napi_callback_info info);
     static napi_value NapiDrawPattern(napi_env env, napi_callback_info info);
+    static napi_value NapiSetCacheDir(napi_env env, napi_callback_info info);
+    static napi_value NapiBenchmarkShapes(napi_env env, napi_callback_info info);
+    static napi_value NapiRunSelfTests(napi_env env, napi_callback_info info);
     
     // CApi XComponent
     void OnSurfaceChanged(OH_NativeXComponent* component, void* window);
@@ -46,18 +52,58 @@ public:
     void DispatchTouchEvent(OH_NativeXComponent* component, void* window);
     void OnSurfaceCreated(OH_NativeXComponent* component, void* window);
 
+    // UI thread: unique XComponent ids for created nodes, the components behind them, and
+    // the surface id render commands use for each component.
+    std::string MakeXComponentId(const std::string& tag) const;
+    void RegisterXComponent(const std::string& id, OH_NativeXComponent* component);
+    void UnregisterXComponent(const std::string& id);
+    OH_NativeXComponent* FindXComponent(const std::string& id) const;
+    uint32_t FindSurface(OH_NativeXComponent* component) const;
+
+    // Executed on the render thread
+    void OnRenderCommand(const RenderCommand& command);
+
 private:
+    void CreateSurface(const RenderCommand& command);
+    void DestroySurface(uint32_t surface);
+    void RemoveSurface(uint32_t surface);
+    void BenchmarkShapes(uint32_t frames, uint32_t shapeCount);
+    void RetryBlockedFrames();
+    // JS thread: settles the promise of a finished benchmark.
+    static void OnBenchmarkComplete(napi_env env, napi_value callback, void* context, void* data);
+
+    /**
+     * One benchmarkShapes() call: the promise to settle, and the results the render thread
+     * fills in before handing the request back to the JS thread through complete.
+     */
+    struct BenchmarkRequest {
+        napi_deferred deferred = nullptr;
+        napi_threadsafe_function complete = nullptr;
+        ShapeBenchmark results[VERTEX_FORMAT_COUNT] = {};
+        size_t count = 0;
+    };
+
     static PluginManager pluginManager_;
     std::unordered_map<std::string, OH_NativeXComponent*> nativeXComponentMap_;
-    std::unordered_map<std::string, PluginManager*> pluginManagerMap_;
+    // Surface ids are never reused, so a component allocated at a freed address cannot
+    // pick up the commands or the core of the one before it.
+    std::unordered_map<OH_NativeXComponent*, uint32_t> surfaceIds_;
+    uint32_t nextSurfaceId_ = 1;
+    // Render thread: one EGLCore per registered XComponent that has had a surface, all
+    // rendering through renderContext_. Cores outlive their surfaces so they resume without
+    // setup, and are released when the XComponent is unregistered.
+    std::unordered_map<uint32_t, EGLCore*> surfaces_;
+    // The benchmark in flight, if any; set by the JS thread and cleared once it settles.
+    std::atomic<BenchmarkRequest*> benchmark_{nullptr};
+    RenderContext renderContext_;
     
 public:
-    EGLCore *eglcore_;
+    RenderThread *renderThread_;
     uint64_t width_;
     uint64_t height_;
     OH_NativeXComponent_TouchEvent touchEvent_;
-    static int32_t hasDraw_;
-    static int32_t hasChangeColor_;
+    static std::atomic<int32_t> hasDraw_;
+    static std::atomic<int32_t> hasChangeColor_;
 };
 } // namespace NativeXComponentSample
 #endif // NATIVE_XCOMPONENT_PLUGIN_MANAGER_H
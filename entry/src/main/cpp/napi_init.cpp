@@ -34,6 +34,12 @@ static napi_value Init(napi_env env, napi_value exports)
         {"getStatus", nullptr, PluginManager::GetXComponentStatus, nullptr, nullptr,
          nullptr, napi_default, nullptr},
         {"drawPattern", nullptr, PluginManager::NapiDrawPattern, nullptr, nullptr,
+         nullptr, napi_default, nullptr},
+        {"setCacheDir", nullptr, PluginManager::NapiSetCacheDir, nullptr, nullptr,
+         nullptr, napi_default, nullptr},
+        {"benchmarkShapes", nullptr, PluginManager::NapiBenchmarkShapes, nullptr, nullptr,
+         nullptr, napi_default, nullptr},
+        {"runSelfTests", nullptr, PluginManager::NapiRunSelfTests, nullptr, nullptr,
          nullptr, napi_default, nullptr}
     };
     if (napi_define_properties(env, exports, sizeof(desc) / sizeof(desc[0]), desc) != napi_ok) {
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "command_list.h"
+
+#include <hilog/log.h>
+
+#include "../common/common.h"
+
+namespace NativeXComponentSample {
+void CommandList::Begin()
+{
+    keys_.clear();
+    commands_.clear();
+    recording_ = true;
+    valid_ = false;
+}
+
+void CommandList::Add(uint64_t key, const DrawCommand& command)
+{
+    if (!recording_) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "CommandList", "Add: not recording");
+        return;
+    }
+    keys_.push_back(key);
+    commands_.push_back(command);
+}
+
+void CommandList::End()
+{
+    valid_ = recording_;
+    recording_ = false;
+}
+
+void CommandList::Invalidate()
+{
+    recording_ = false;
+    valid_ = false;
+}
+
+uint32_t CommandList::Replay(DrawList& target) const
+{
+    if (!valid_) {
+        return 0;
+    }
+    target.Append(keys_.data(), commands_.data(), commands_.size());
+    return static_cast<uint32_t>(commands_.size());
+}
+} // namespace NativeXComponentSample
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_COMMAND_LIST_H
+#define NATIVE_XCOMPONENT_COMMAND_LIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "render/draw_list.h"
+
+namespace NativeXComponentSample {
+/**
+ * Sort-keyed draws recorded once and replayed into a frame's DrawList with one call.
+ * Recorded commands may only reference GL objects that outlive the list (not ring buffer
+ * allocations). The owner invalidates the list whenever anything baked into the commands
+ * changes, e.g. the surface size or the content; replaying an invalid list does nothing.
+ */
+class CommandList {
+public:
+    // Discards the previous recording; the list stays invalid until End().
+    void Begin();
+    void Add(uint64_t key, const DrawCommand& command);
+    void End();
+    void Invalidate();
+    uint32_t Replay(DrawList& target) const;
+    bool Valid() const
+    {
+        return valid_;
+    }
+    size_t Size() const
+    {
+        return commands_.size();
+    }
+
+private:
+    std::vector<uint64_t> keys_;
+    std::vector<DrawCommand> commands_;
+    bool recording_ = false;
+    bool valid_ = false;
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_COMMAND_LIST_H
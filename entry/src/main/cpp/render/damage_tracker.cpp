@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "damage_tracker.h"
+
+#include <algorithm>
+
+namespace NativeXComponentSample {
+void DamageTracker::Reset(GLint width, GLint height)
+{
+    width_ = width;
+    height_ = height;
+    historyCount_ = 0;
+    AddFull();
+}
+
+void DamageTracker::Add(const DamageRect& rect)
+{
+    // Clip to the surface; EGL rejects damage outside of it.
+    GLint left = std::max(rect.x, 0);
+    GLint bottom = std::max(rect.y, 0);
+    GLint right = std::min(rect.x + rect.width, width_);
+    GLint top = std::min(rect.y + rect.height, height_);
+    if ((rect.Empty()) || (right <= left) || (top <= bottom)) {
+        return;
+    }
+    current_ = Union(current_, { left, bottom, right - left, top - bottom });
+}
+
+void DamageTracker::AddFull()
+{
+    current_ = { 0, 0, width_, height_ };
+}
+
+DamageRect DamageTracker::Resolve(GLint bufferAge) const
+{
+    if ((bufferAge <= 0) || (static_cast<uint32_t>(bufferAge) > historyCount_ + 1)) {
+        return { 0, 0, width_, height_ };
+    }
+    DamageRect region = current_;
+    for (GLint i = 0; i < bufferAge - 1; ++i) {
+        region = Union(region, history_[i]);
+    }
+    return region;
+}
+
+void DamageTracker::EndFrame()
+{
+    for (uint32_t i = MAX_BUFFER_AGE - 1; i > 0; --i) {
+        history_[i] = history_[i - 1];
+    }
+    history_[0] = current_;
+    historyCount_ = std::min(historyCount_ + 1, MAX_BUFFER_AGE);
+    current_ = {};
+}
+
+DamageRect DamageTracker::Union(const DamageRect& a, const DamageRect& b)
+{
+    if (a.Empty()) {
+        return b;
+    }
+    if (b.Empty()) {
+        return a;
+    }
+    GLint left = std::min(a.x, b.x);
+    GLint bottom = std::min(a.y, b.y);
+    GLint right = std::max(a.x + a.width, b.x + b.width);
+    GLint top = std::max(a.y + a.height, b.y + b.height);
+    return { left, bottom, right - left, top - bottom };
+}
+} // namespace NativeXComponentSample
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_DAMAGE_TRACKER_H
+#define NATIVE_XCOMPONENT_DAMAGE_TRACKER_H
+
+#include <cstdint>
+#include <epoxy/gl.h>
+
+namespace NativeXComponentSample {
+/**
+ * Rectangle in surface pixels, origin bottom-left as used by glScissor and EGL damage.
+ */
+struct DamageRect {
+    GLint x;
+    GLint y;
+    GLint width;
+    GLint height;
+
+    bool Empty() const
+    {
+        return (width <= 0) || (height <= 0);
+    }
+};
+
+/**
+ * Collects the screen area that changed this frame and resolves what has to be redrawn
+ * into a back buffer of a given EGL_EXT_buffer_age: the union of this frame's damage
+ * and that of the age - 1 frames before it. Damage is kept as one bounding rectangle
+ * per frame, which is what a single scissor can express.
+ */
+class DamageTracker {
+public:
+    // Drops the history and damages the whole (new) surface.
+    void Reset(GLint width, GLint height);
+    void Add(const DamageRect& rect);
+    void AddFull();
+    bool Empty() const
+    {
+        return current_.Empty();
+    }
+    // Age 0 (undefined contents) or older than the history resolves to the full surface.
+    DamageRect Resolve(GLint bufferAge) const;
+    bool IsFull(const DamageRect& rect) const
+    {
+        return (rect.x <= 0) && (rect.y <= 0) && (rect.width >= width_) && (rect.height >= height_);
+    }
+    // Pushes this frame's damage into the history; call once per presented frame.
+    void EndFrame();
+
+    static constexpr uint32_t MAX_BUFFER_AGE = 4;
+
+private:
+    static DamageRect Union(const DamageRect& a, const DamageRect& b);
+
+    GLint width_ = 0;
+    GLint height_ = 0;
+    DamageRect current_ = {};
+    // history_[0] is the previous frame.
+    DamageRect history_[MAX_BUFFER_AGE] = {};
+    uint32_t historyCount_ = 0;
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_DAMAGE_TRACKER_H
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "draw_list.h"
+
+#include <cstring>
+#include <utility>
+
+namespace NativeXComponentSample {
+namespace {
+/**
+ * Bits per radix digit and the resulting bucket count.
+ */
+const uint32_t RADIX_BITS = 8;
+const uint32_t RADIX_BUCKETS = 1 << RADIX_BITS;
+
+/**
+ * Digits of a 64-bit key.
+ */
+const uint32_t RADIX_DIGITS = 64 / RADIX_BITS;
+
+/**
+ * Key field widths, see DrawList.
+ */
+const uint32_t LAYER_BITS = 8;
+const uint32_t PROGRAM_BITS = 11;
+const uint32_t TEXTURE_BITS = 12;
+const uint32_t DEPTH_BITS = 32;
+
+/**
+ * Items reserved up front so typical frames never reallocate.
+ */
+const size_t INITIAL_ITEM_RESERVE = 64;
+
+uint64_t Field(uint64_t value, uint32_t bits)
+{
+    return value & ((uint64_t(1) << bits) - 1);
+}
+
+// Maps a float to an unsigned integer with the same ordering.
+uint32_t SortableDepth(GLfloat depth)
+{
+    uint32_t bits;
+    memcpy(&bits, &depth, sizeof(bits));
+    return ((bits & 0x80000000u) != 0) ? ~bits : (bits | 0x80000000u);
+}
+} // namespace
+
+uint64_t DrawList::MakeKey(uint8_t layer, GLuint program, GLuint texture, bool blend, GLfloat depth)
+{
+    uint64_t state = (Field(program, PROGRAM_BITS) << TEXTURE_BITS) | Field(texture, TEXTURE_BITS);
+    uint64_t key = 0;
+    if (!blend) {
+        uint8_t topFirst = static_cast<uint8_t>(~layer);
+        key = (uint64_t(topFirst) << (PROGRAM_BITS + TEXTURE_BITS + DEPTH_BITS)) |
+            (state << DEPTH_BITS) | SortableDepth(depth);
+    } else {
+        uint32_t farFirst = ~SortableDepth(depth);
+        key = (uint64_t(1) << (LAYER_BITS + PROGRAM_BITS + TEXTURE_BITS + DEPTH_BITS)) |
+            (uint64_t(layer) << (PROGRAM_BITS + TEXTURE_BITS + DEPTH_BITS)) |
+            (uint64_t(farFirst) << (PROGRAM_BITS + TEXTURE_BITS)) | state;
+    }
+    return key;
+}
+
+void DrawList::Add(uint64_t key, const DrawCommand& command)
+{
+    if (commands_.capacity() == 0) {
+        commands_.reserve(INITIAL_ITEM_RESERVE);
+        items_.reserve(INITIAL_ITEM_RESERVE);
+    }
+    items_.push_back({ key, static_cast<uint32_t>(commands_.size()) });
+    commands_.push_back(command);
+}
+
+void DrawList::Append(const uint64_t* keys, const DrawCommand* commands, size_t count)
+{
+    if ((keys == nullptr) || (commands == nullptr) || (count == 0)) {
+        return;
+    }
+    size_t base = commands_.size();
+    commands_.insert(commands_.end(), commands, commands + count);
+    items_.reserve(items_.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        items_.push_back({ keys[i], static_cast<uint32_t>(base + i) });
+    }
+}
+
+void DrawList::Sort()
+{
+    stats_.radixPasses = 0;
+    size_t count = items_.size();
+    if (count < 2) {
+        return;
+    }
+    scratch_.resize(count);
+
+    // Histogram every digit in one pass; digits shared by all keys need no pass.
+    uint32_t histograms[RADIX_DIGITS][RADIX_BUCKETS] = {};
+    for (const SortItem& item : items_) {
+        for (uint32_t digit = 0; digit < RADIX_DIGITS; ++digit) {
+            ++histograms[digit][(item.key >> (digit * RADIX_BITS)) & (RADIX_BUCKETS - 1)];
+        }
+    }
+
+    // Stable LSD passes, ping-ponging between items_ and scratch_.
+    std::vector<SortItem>* source = &items_;
+    std::vector<SortItem>* target = &scratch_;
+    for (uint32_t digit = 0; digit < RADIX_DIGITS; ++digit) {
+        uint32_t* histogram = histograms[digit];
+        uint32_t shift = digit * RADIX_BITS;
+        if (histogram[((*source)[0].key >> shift) & (RADIX_BUCKETS - 1)] == count) {
+            continue;
+        }
+        uint32_t offset = 0;
+        for (uint32_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket) {
+            uint32_t bucketCount = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketCount;
+        }
+        for (const SortItem& item : *source) {
+            (*target)[histogram[(item.key >> shift) & (RADIX_BUCKETS - 1)]++] = item;
+        }
+        std::swap(source, target);
+        ++stats_.radixPasses;
+    }
+    if (source != &items_) {
+        items_.swap(scratch_);
+    }
+}
+
+uint32_t DrawList::Submit(GLStateCache& stateCache)
+{
+    stats_.items = static_cast<uint32_t>(items_.size());
+    stats_.programChanges = 0;
+    stats_.textureChanges = 0;
+    stats_.blendChanges = 0;
+
+    const DrawCommand* previous = nullptr;
+    for (const SortItem& item : items_) {
+        const DrawCommand& command = commands_[item.command];
+        if ((previous == nullptr) || (previous->program != command.program)) {
+            ++stats_.programChanges;
+        }
+        if ((previous == nullptr) || (previous->texture != command.texture)) {
+            ++stats_.textureChanges;
+        }
+        if ((previous == nullptr) || (previous->blend != command.blend)) {
+            ++stats_.blendChanges;
+        }
+        previous = &command;
+
+        // Redundant binds are filtered by the state cache.
+        stateCache.UseProgram(command.program);
+        if (command.texture != 0) {
+            stateCache.BindTexture(GL_TEXTURE_2D, command.texture);
+        }
+        if (command.blend) {
+            stateCache.Enable(GL_BLEND);
+            // Alpha always accumulates as coverage, so off-screen targets end up premultiplied.
+            stateCache.BlendFuncSeparate(command.premultiplied ? GL_ONE : GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
+                                         GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            stateCache.DepthMask(GL_FALSE);
+        } else {
+            stateCache.Disable(GL_BLEND);
+            stateCache.DepthMask(GL_TRUE);
+        }
+        stateCache.BindVertexArray(command.vertexArray);
+
+        // The gl function has no return value.
+        if (command.drawUniform >= 0) {
+            glUniform4fv(command.drawUniform, 1, command.drawParams);
+        }
+        if (command.indexType == GL_NONE) {
+            if (command.instances > 1) {
+                glDrawArraysInstanced(command.mode, command.first, command.count, command.instances);
+            } else {
+                glDrawArrays(command.mode, command.first, command.count);
+            }
+        } else {
+            const void* indices = reinterpret_cast<const void*>(command.indexOffset);
+            if (command.instances > 1) {
+                glDrawElementsInstanced(command.mode, command.count, command.indexType, indices, command.instances);
+            } else {
+                glDrawElements(command.mode, command.count, command.indexType, indices);
+            }
+        }
+    }
+    // Leave depth writes on so the next frame's depth clear takes effect.
+    stateCache.DepthMask(GL_TRUE);
+    return stats_.items;
+}
+
+void DrawList::Clear()
+{
+    commands_.clear();
+    items_.clear();
+}
+} // namespace NativeXComponentSample
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_DRAW_LIST_H
+#define NATIVE_XCOMPONENT_DRAW_LIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <epoxy/gl.h>
+#include <vector>
+#include "render/gl_state_cache.h"
+
+namespace NativeXComponentSample {
+/**
+ * One recorded draw with all state it needs. Buffers it reads must stay valid until the
+ * list is submitted. drawParams is written to the program's u_draw vec4 when drawUniform
+ * is valid, so items sharing a program can still differ in their per-draw constants.
+ */
+struct DrawCommand {
+    GLuint program;
+    GLuint vertexArray;
+    GLuint texture;
+    GLenum mode;
+    GLsizei count;
+    // GL_NONE draws arrays starting at `first`; otherwise the index type of `indexOffset`.
+    GLenum indexType;
+    GLint first;
+    GLintptr indexOffset;
+    GLsizei instances;
+    bool blend;
+    // Source color is already multiplied by alpha, e.g. a cached layer texture.
+    bool premultiplied;
+    GLint drawUniform;
+    GLfloat drawParams[4];
+};
+
+/**
+ * Per-submit counters; the state change counts are what sorting minimizes.
+ */
+struct DrawListStats {
+    uint32_t items;
+    uint32_t programChanges;
+    uint32_t textureChanges;
+    uint32_t blendChanges;
+    uint32_t radixPasses;
+};
+
+/**
+ * Per-frame list of draws ordered by a packed 64-bit sort key before submission.
+ *
+ * Key layout, most significant bit first:
+ *   opaque:      0 | layer (top first, 8) | program (11) | texture (12) | depth (near first, 32)
+ *   translucent: 1 | layer (bottom first, 8) | depth (far first, 32) | program (11) | texture (12)
+ * Opaque draws therefore come first, grouped by state and front to back within a state;
+ * translucent draws follow in painter's order. layer is the painter's order of the item
+ * (0 = bottom) and depth the clip-space z of the item's nearest (opaque) or farthest
+ * (translucent) point. Program and texture names are truncated, which only affects grouping.
+ */
+class DrawList {
+public:
+    static uint64_t MakeKey(uint8_t layer, GLuint program, GLuint texture, bool blend, GLfloat depth);
+
+    void Add(uint64_t key, const DrawCommand& command);
+    // Bulk Add() of count prerecorded items, see CommandList.
+    void Append(const uint64_t* keys, const DrawCommand* commands, size_t count);
+    void Sort();
+    uint32_t Submit(GLStateCache& stateCache);
+    void Clear();
+    bool Empty() const
+    {
+        return commands_.empty();
+    }
+    const DrawListStats& LastStats() const
+    {
+        return stats_;
+    }
+
+private:
+    friend class SelfTest;
+
+    /**
+     * Sorted element: key plus index of the command, so sorting moves 16 bytes per item.
+     */
+    struct SortItem {
+        uint64_t key;
+        uint32_t command;
+    };
+
+    std::vector<DrawCommand> commands_;
+    std::vector<SortItem> items_;
+    std::vector<SortItem> scratch_;
+    DrawListStats stats_ = {};
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_DRAW_LIST_H
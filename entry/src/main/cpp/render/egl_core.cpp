@@ -19,25 +19,64 @@
 #include <EGL/eglext.h>
 #include <EGL/eglplatform.h>
 #include <GLES3/gl3.h>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
 #include <cstdio>
+#include <cstring>
 #include <hilog/log.h>
 
 #include "../common/common.h"
+#include "program_cache.h"
+#include "shape_library.h"
 
 namespace NativeXComponentSample {
 namespace {
-constexpr int32_t NUM_4 = 4;
 /**
- * Vertex shader.
+ * Unit star mesh of the instanced star pass, generated at compile time.
+ */
+using StarShape = Pentagram;
+
+/**
+ * Outer radius of the default star, as a fraction of the surface height.
+ */
+const GLfloat DEFAULT_STAR_RADIUS = 0.324f;
+
+/**
+ * Vertical center of the default star, as a fraction of the surface height.
+ */
+const GLfloat DEFAULT_STAR_CENTER_Y = -0.074f;
+
+/**
+ * Components of a vec2 attribute.
+ */
+constexpr GLint VEC2_SIZE = 2;
+
+/**
+ * Components of a vec4 attribute.
+ */
+constexpr GLint VEC4_SIZE = 4;
+
+/**
+ * Vertex shader. Positions are in pixels relative to the surface center, scaled by
+ * u_draw.z; the shared view block maps pixels to clip space. u_draw.xy orders vertices
+ * front to back by submission, see GeometryBatcher; the depth is scaled by w so it
+ * survives the perspective divide of a projective view.
  */
 const char VERTEX_SHADER[] = "#version 300 es\n"
                              "layout(location = 0) in vec4 a_position;\n"
                              "layout(location = 1) in vec4 a_color;   \n"
+                             "layout(std140) uniform ViewBlock {      \n"
+                             "   mat4 u_viewProjection;               \n"
+                             "};                                      \n"
+                             "uniform vec4 u_draw;                    \n"
                              "out vec4 v_color;                       \n"
                              "void main()                             \n"
                              "{                                       \n"
-                             "   gl_Position = a_position;            \n"
+                             "   gl_Position = u_viewProjection * vec4(a_position.xy * u_draw.z, 0.0, 1.0);\n"
+                             "   float depth = u_draw.x - float(gl_VertexID) * u_draw.y;\n"
+                             "   gl_Position.z = depth * gl_Position.w;\n"
                              "   v_color = a_color;                   \n"
                              "}                                       \n";
 
@@ -54,7 +93,68 @@ const char FRAGMENT_SHADER[] = "#version 300 es\n"
                                "}                                         \n";
 
 /**
- * Background color #f4f4f4.
+ * Instanced star vertex shader. a_transform is (center.xy, rotation, radius) in pixels
+ * relative to the surface center; color and an extra transform come from the style
+ * selected by a_style. The style array length must match MAX_DRAW_STYLES.
+ */
+const char STAR_VERTEX_SHADER[] = "#version 300 es\n"
+                                  "layout(location = 0) in vec2 a_position;\n"
+                                  "layout(location = 1) in vec4 a_transform;\n"
+                                  "layout(location = 2) in uint a_style;    \n"
+                                  "struct Style {                            \n"
+                                  "   mat4 transform;                        \n"
+                                  "   vec4 color;                            \n"
+                                  "};                                        \n"
+                                  "layout(std140) uniform StyleBlock {       \n"
+                                  "   Style u_styles[64];                    \n"
+                                  "};                                        \n"
+                                  "layout(std140) uniform ViewBlock {        \n"
+                                  "   mat4 u_viewProjection;                 \n"
+                                  "};                                        \n"
+                                  "uniform vec4 u_draw;                      \n"
+                                  "out vec4 v_color;                         \n"
+                                  "void main()                               \n"
+                                  "{                                         \n"
+                                  "   float c = cos(a_transform.z);          \n"
+                                  "   float s = sin(a_transform.z);          \n"
+                                  "   vec2 p = mat2(c, s, -s, c) * a_position * a_transform.w + a_transform.xy;\n"
+                                  "   gl_Position = u_viewProjection * u_styles[a_style].transform * vec4(p, 0.0, 1.0);\n"
+                                  "   float depth = u_draw.x - float(gl_InstanceID) * u_draw.y;\n"
+                                  "   gl_Position.z = depth * gl_Position.w;\n"
+                                  "   v_color = u_styles[a_style].color;     \n"
+                                  "}                                         \n";
+static_assert(MAX_DRAW_STYLES == 64, "STAR_VERTEX_SHADER declares u_styles[64]");
+
+/**
+ * Cached layer composite vertex shader. a_position is a corner of the full-surface quad
+ * in clip space; u_draw.x is the depth it is composited at and u_draw.yz the part of the
+ * layer storage holding content.
+ */
+const char LAYER_VERTEX_SHADER[] = "#version 300 es\n"
+                                   "layout(location = 0) in vec2 a_position;\n"
+                                   "uniform vec4 u_draw;                      \n"
+                                   "out vec2 v_texCoord;                      \n"
+                                   "void main()                               \n"
+                                   "{                                         \n"
+                                   "   v_texCoord = (a_position * 0.5 + 0.5) * u_draw.yz;\n"
+                                   "   gl_Position = vec4(a_position, u_draw.x, 1.0);\n"
+                                   "}                                         \n";
+
+/**
+ * Cached layer composite fragment shader; layer textures are premultiplied.
+ */
+const char LAYER_FRAGMENT_SHADER[] = "#version 300 es\n"
+                                     "precision mediump float;                  \n"
+                                     "uniform sampler2D u_texture;              \n"
+                                     "in vec2 v_texCoord;                       \n"
+                                     "out vec4 fragColor;                       \n"
+                                     "void main()                               \n"
+                                     "{                                         \n"
+                                     "   fragColor = texture(u_texture, v_texCoord);\n"
+                                     "}                                         \n";
+
+/**
+ * Background color #f4f4f4, used as the clear color so the background costs no fill.
  */
 const GLfloat BACKGROUND_COLOR[] = {244.0f / 255, 244.0f / 255, 244.0f / 255, 1.0f};
 
@@ -69,193 +169,182 @@ const GLfloat DRAW_COLOR[] = {126.0f / 255, 143.0f / 255, 251.0f / 255, 1.0f};
 const GLfloat CHANGE_COLOR[] = {146.0f / 255, 214.0f / 255, 204.0f / 255, 1.0f};
 
 /**
- * Background area.
+ * Buffers in EGLCore::SharedResources: star mesh, star indices, layer quad.
  */
-const GLfloat BACKGROUND_RECTANGLE_VERTICES[] = {
-    -1.0f, 1.0f,
-    1.0f, 1.0f,
-    1.0f, -1.0f,
-    -1.0f, -1.0f};
+const GLsizei SHARED_BUFFER_COUNT = 3;
 
 /**
- * Get context parameter count.
+ * Fifty percent.
  */
-const size_t GET_CONTEXT_PARAM_CNT = 1;
+const float FIFTY_PERCENT = 0.5;
 
 /**
- * Fifty percent.
+ * Default x position.
  */
-const float FIFTY_PERCENT = 0.5;
+const int DEFAULT_X_POSITION = 0;
 
 /**
- * Pointer size.
+ * Default y position.
  */
-const GLint POINTER_SIZE = 2;
+const int DEFAULT_Y_POSITION = 0;
 
 /**
- * Triangle fan size.
+ * Program error.
  */
-const GLsizei TRIANGLE_FAN_SIZE = 4;
+const GLuint PROGRAM_ERROR = 0;
 
 /**
- * Egl red size default.
+ * Position handle name.
  */
-const int EGL_RED_SIZE_DEFAULT = 8;
+const char POSITION_NAME[] = "a_position";
 
 /**
- * Egl green size default.
+ * Color handle name.
  */
-const int EGL_GREEN_SIZE_DEFAULT = 8;
+const char COLOR_NAME[] = "a_color";
 
 /**
- * Egl blue size default.
+ * Instance style index handle name.
  */
-const int EGL_BLUE_SIZE_DEFAULT = 8;
+const char STYLE_NAME[] = "a_style";
 
 /**
- * Egl alpha size default.
+ * Style uniform block name.
  */
-const int EGL_ALPHA_SIZE_DEFAULT = 8;
+const char STYLE_BLOCK_NAME[] = "StyleBlock";
 
 /**
- * Default x position.
+ * Uniform buffer binding point of the style block.
  */
-const int DEFAULT_X_POSITION = 0;
+const GLuint STYLE_BLOCK_BINDING = 0;
 
 /**
- * Default y position.
+ * 4x4 identity matrix, column major.
  */
-const int DEFAULT_Y_POSITION = 0;
+const GLfloat IDENTITY_MATRIX[] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f};
 
 /**
- * Gl red default.
+ * Instance transform handle name.
  */
-const GLfloat GL_RED_DEFAULT = 0.5;
+const char TRANSFORM_NAME[] = "a_transform";
 
 /**
- * Gl green default.
+ * Per-draw constants uniform name, see DrawCommand::drawParams.
  */
-const GLfloat GL_GREEN_DEFAULT = 0.5;
+const char DRAW_PARAMS_NAME[] = "u_draw";
 
 /**
- * Gl blue default.
+ * Painter's order of the built-in layers; batched shapes sit above the stars.
  */
-const GLfloat GL_BLUE_DEFAULT = 0.0;
+const uint8_t STAR_LAYER = 0;
+const uint8_t SHAPE_LAYER = 1;
 
 /**
- * Gl alpha default.
+ * Layer texture sampler name; always sampled from texture unit 0.
  */
-const GLfloat GL_ALPHA_DEFAULT = 1.0;
+const char TEXTURE_NAME[] = "u_texture";
 
 /**
- * Program error.
+ * Full-surface quad in clip space, drawn as a triangle strip.
  */
-const GLuint PROGRAM_ERROR = 0;
+const GLfloat LAYER_QUAD[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
 
 /**
- * Shape vertices size.
+ * Vertices of LAYER_QUAD.
  */
-const int SHAPE_VERTICES_SIZE = 8;
+const GLsizei LAYER_QUAD_VERTICES = 4;
 
 /**
- * Position handle name.
+ * Depth the cached star layer is composited at: behind batched shapes, in front of the clear.
  */
-const char POSITION_NAME[] = "a_position";
+const GLfloat STAR_LAYER_COMPOSITE_DEPTH = 0.999f;
+
+/**
+ * Shared view uniform block name.
+ */
+const char VIEW_BLOCK_NAME[] = "ViewBlock";
+
+/**
+ * Uniform buffer binding point of the view block, shared by all programs.
+ */
+const GLuint VIEW_BLOCK_BINDING = 1;
+
+/**
+ * Rows and columns of a 4x4 matrix.
+ */
+constexpr int MATRIX_DIMENSION = 4;
 
 /**
- * Position error.
+ * Location reflected for an attribute or uniform the program does not use.
  */
 const GLint POSITION_ERROR = -1;
 
 /**
- * Config attribute list.
+ * Pixels added around projected bounds to cover rasterization rounding.
  */
-const EGLint ATTRIB_LIST[] = {
-    // Key,value.
-    EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
-    EGL_RED_SIZE, EGL_RED_SIZE_DEFAULT,
-    EGL_GREEN_SIZE, EGL_GREEN_SIZE_DEFAULT,
-    EGL_BLUE_SIZE, EGL_BLUE_SIZE_DEFAULT,
-    EGL_ALPHA_SIZE, EGL_ALPHA_SIZE_DEFAULT,
-    EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT_KHR,
-    // End.
-    EGL_NONE};
+const GLint DAMAGE_MARGIN = 1;
 
 /**
- * Context attributes.
+ * Upper bound for a single wait on an in-flight frame fence (one second).
  */
-const EGLint CONTEXT_ATTRIBS[] = {
-    EGL_CONTEXT_CLIENT_VERSION, 3,
-    EGL_NONE};
-} // namespace
+const GLuint64 FRAME_FENCE_TIMEOUT_NS = 1000000000;
+
+/**
+ * Size of the dynamic vertex ring; see EGLCore::DynamicBufferStats() to tune it.
+ */
+const GLsizeiptr DYNAMIC_RING_CAPACITY = 4 * 1024 * 1024;
 
-typedef EGLBoolean (*eglInitialize_t)(EGLDisplay, EGLint*, EGLint*);
-typedef EGLDisplay (*eglGetDisplay_t)(EGLNativeDisplayType);
+/**
+ * Radius of a benchmark star relative to its grid cell.
+ */
+const GLfloat BENCHMARK_STAR_SCALE = 0.4f;
 
-bool EGLCore::EglContextInit(void* window, int width, int height)
+// point = matrix * point for a column-major 4x4 matrix.
+void TransformPoint(const GLfloat matrix[16], GLfloat point[MATRIX_DIMENSION])
 {
-    // setup mesa for our needs
-    setenv("MESA_LOADER_DRIVER_OVERRIDE", "zink", 1);
-    setenv("EGL_LOG_LEVEL", "debug", 1);
-    setenv("MESA_LOG", "ohos", 1);
-    setenv("MESA_GLES_VERSION_OVERRIDE", "3.1", 1);
-    setenv("ZINK_DEBUG", "spirv,nir", 1);
+    GLfloat result[MATRIX_DIMENSION] = {};
+    for (int row = 0; row < MATRIX_DIMENSION; ++row) {
+        for (int k = 0; k < MATRIX_DIMENSION; ++k) {
+            result[row] += matrix[k * MATRIX_DIMENSION + row] * point[k];
+        }
+    }
+    memcpy(point, result, sizeof(result));
+}
+} // namespace
+
+EGLCore::SharedResources EGLCore::shared_;
 
+bool EGLCore::EglContextInit(RenderContext* context, void* window, int width, int height)
+{
     OH_LOG_Print(LOG_APP, LOG_INFO, LOG_PRINT_DOMAIN, "EGLCore", "EglContextInit execute");
-    if ((window == nullptr) || (width <= 0) || (height <= 0)) {
+    if ((context == nullptr) || !context->Ready() || (window == nullptr) || (width <= 0) || (height <= 0)) {
         OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "EglContextInit: param error");
         return false;
     }
 
     UpdateSize(width, height);
+    context_ = context;
+    stateCache_ = &context->StateCache();
     eglWindow_ = static_cast<EGLNativeWindowType>(window);
-
-    // Init display.
-    eglDisplay_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
-    if (eglDisplay_ == EGL_NO_DISPLAY) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "eglGetDisplay: unable to get EGL display");
-        return false;
-    }
-
-    EGLint majorVersion;
-    EGLint minorVersion;
-    if (!eglInitialize(eglDisplay_, &majorVersion, &minorVersion)) {
-        OH_LOG_Print(
-            LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "eglInitialize: unable to get initialize EGL display");
-        return false;
-    }
-
-    const char *egl_vendor = eglQueryString(eglDisplay_, EGL_VENDOR);
-    const int GLOBAL_RESMGR = 0xFF00;
-    const char *TAG = "[egl]";
-    OH_LOG_Print(LOG_APP, LOG_INFO, GLOBAL_RESMGR, TAG, " dlopen egl vendor %{public}s", egl_vendor);
-
-    // Select configuration.
-    const EGLint maxConfigSize = 1;
-    EGLint numConfigs;
-    if (!eglChooseConfig(eglDisplay_, ATTRIB_LIST, &eglConfig_, maxConfigSize, &numConfigs)) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "eglChooseConfig: unable to choose configs");
-        return false;
-    }
     return CreateEnvironment();
 }
 
 bool EGLCore::CreateEnvironment()
 {
-    // Create surface.
+    // Create surface; the context is shared with every other surface.
     if (eglWindow_ == nullptr) {
         OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "eglWindow_ is null");
         return false;
     }
-    eglSurface_ = eglCreateWindowSurface(eglDisplay_, eglConfig_, eglWindow_, NULL);
-    if (eglSurface_ == nullptr) {
-        OH_LOG_Print(
-            LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "eglCreateWindowSurface: unable to create surface");
+    eglSurface_ = context_->CreateWindowSurface(eglWindow_);
+    if (eglSurface_ == EGL_NO_SURFACE) {
         return false;
     }
-    // Create context.
-    eglContext_ = eglCreateContext(eglDisplay_, eglConfig_, EGL_NO_CONTEXT, CONTEXT_ATTRIBS);
-    if (!eglMakeCurrent(eglDisplay_, eglSurface_, eglSurface_, eglContext_)) {
+    if (!context_->MakeCurrent(eglSurface_)) {
         OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "eglMakeCurrent failed");
         return false;
     }
@@ -265,246 +354,892 @@ bool EGLCore::CreateEnvironment()
     OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "vendor: %{public}s", vendor);
     OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "renderer: %{public}s", renderer);
 
-    // Create program.
-    program_ = CreateProgram(VERTEX_SHADER, FRAGMENT_SHADER);
-    if (program_ == PROGRAM_ERROR) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "CreateProgram: unable to create program");
+    // Programs and static meshes are shared by every surface and context of the device.
+    if (!AcquireSharedResources()) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "unable to create shared resources");
+        return false;
+    }
+
+    // Incremental presents; every extension is optional and checked separately.
+    bufferAgeSupported_ = context_->HasExtension("EGL_EXT_buffer_age");
+    partialUpdateSupported_ = bufferAgeSupported_ && context_->HasExtension("EGL_KHR_partial_update");
+    swapWithDamageSupported_ = context_->HasExtension("EGL_KHR_swap_buffers_with_damage");
+
+    // Core in GLES 3.0: an all-ones index ends the current fan or strip, so indexed draws
+    // can merge many of them into one call.
+    stateCache_->Enable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+    // Layers are separated by depth, so opaque content can be drawn front to back.
+    stateCache_->Enable(GL_DEPTH_TEST);
+
+    // Upload geometry once; steady-state frames only bind the VAOs.
+    if (!CreateGeometry()) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "CreateGeometry: unable to create geometry");
+        return false;
+    }
+
+    // Per-frame dynamic data is streamed through one fence-guarded ring.
+    if (!ringBuffer_.Init(stateCache_, GL_ARRAY_BUFFER, DYNAMIC_RING_CAPACITY)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "ring buffer init failed");
+        return false;
+    }
+
+    // Free-form shapes share the flat color program as one interleaved stream.
+    BatchProgram batchProgram = { colorProgram_.id, colorProgram_.position, colorProgram_.color, colorProgram_.draw };
+    if (!batcher_.Init(stateCache_, &ringBuffer_, &drawList_, batchProgram, SHAPE_LAYER)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "batcher init failed");
+        return false;
+    }
+
+    // Unchanged layers stay in textures, bounded by the layer budget.
+    if (!layerCache_.Init(stateCache_)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "layer cache init failed");
         return false;
     }
     return true;
 }
 
-void EGLCore::Background()
+bool EGLCore::AcquireSharedResources()
 {
-    GLint position = PrepareDraw();
-    if (position == POSITION_ERROR) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Background get position failed");
-        return;
+    if (!shared_.ready) {
+        // First surface of the process: compile and upload into the device's share group.
+        if (!CreatePrograms()) {
+            OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "CreateProgram: unable to create program");
+            return false;
+        }
+        GLuint buffers[SHARED_BUFFER_COUNT] = {};
+        glGenBuffers(SHARED_BUFFER_COUNT, buffers);
+        if ((buffers[0] == 0) || (buffers[1] == 0) || (buffers[2] == 0)) {
+            OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "unable to create shared buffers");
+            glDeleteBuffers(SHARED_BUFFER_COUNT, buffers);
+            return false;
+        }
+        // The gl function has no return value.
+        // The star tables are constant data; creating the mesh is a plain upload. Element
+        // buffer binds are vertex array state, so upload through the default vertex array.
+        stateCache_->BindVertexArray(0);
+        stateCache_->BindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(StarShape::TABLES.vertices), StarShape::TABLES.vertices.data(),
+                     GL_STATIC_DRAW);
+        stateCache_->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(StarShape::TABLES.indices), StarShape::TABLES.indices.data(),
+                     GL_STATIC_DRAW);
+        stateCache_->BindBuffer(GL_ARRAY_BUFFER, buffers[2]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(LAYER_QUAD), LAYER_QUAD, GL_STATIC_DRAW);
+
+        shared_.colorProgram = colorProgram_;
+        shared_.starProgram = starProgram_;
+        shared_.layerProgram = layerProgram_;
+        shared_.starMeshVbo = buffers[0];
+        shared_.starIndexBuffer = buffers[1];
+        shared_.layerQuadVbo = buffers[2];
+        shared_.ready = true;
     }
+    colorProgram_ = shared_.colorProgram;
+    starProgram_ = shared_.starProgram;
+    layerProgram_ = shared_.layerProgram;
+    starMeshVbo_ = shared_.starMeshVbo;
+    starIndexBuffer_ = shared_.starIndexBuffer;
+    layerQuadVbo_ = shared_.layerQuadVbo;
+    if (!sharedAcquired_) {
+        sharedAcquired_ = true;
+        ++shared_.users;
+    }
+    return true;
+}
 
-    if (!ExecuteDraw(position, BACKGROUND_COLOR,
-                     BACKGROUND_RECTANGLE_VERTICES, sizeof(BACKGROUND_RECTANGLE_VERTICES))) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Background execute draw failed");
+void EGLCore::ReleaseSharedResources()
+{
+    if (!sharedAcquired_) {
         return;
     }
-
-    if (!FinishDraw()) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Background FinishDraw failed");
+    sharedAcquired_ = false;
+    if (--shared_.users > 0) {
         return;
     }
+    // Last core of the process; a later surface compiles and uploads them again.
+    const GLuint programs[] = { shared_.colorProgram.id, shared_.starProgram.id, shared_.layerProgram.id };
+    for (GLuint program : programs) {
+        stateCache_->OnProgramDeleted(program);
+        glDeleteProgram(program);
+    }
+    GLuint buffers[SHARED_BUFFER_COUNT] = { shared_.starMeshVbo, shared_.starIndexBuffer, shared_.layerQuadVbo };
+    for (GLuint buffer : buffers) {
+        stateCache_->OnBufferDeleted(buffer);
+    }
+    glDeleteBuffers(SHARED_BUFFER_COUNT, buffers);
+    shared_ = SharedResources();
+}
+
+void EGLCore::AbandonSharedResources()
+{
+    shared_ = SharedResources();
+}
+
+bool EGLCore::CreatePrograms()
+{
+    ProgramInterface reflection;
+    colorProgram_.id = CreateProgram(VERTEX_SHADER, FRAGMENT_SHADER, reflection);
+    if (colorProgram_.id == PROGRAM_ERROR) {
+        return false;
+    }
+    colorProgram_.position = reflection.Attribute(POSITION_NAME);
+    colorProgram_.color = reflection.Attribute(COLOR_NAME);
+    colorProgram_.draw = reflection.Uniform(DRAW_PARAMS_NAME);
+    colorProgram_.viewBlock = reflection.UniformBlock(VIEW_BLOCK_NAME);
+    if (colorProgram_.viewBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(colorProgram_.id, colorProgram_.viewBlock, VIEW_BLOCK_BINDING);
+    }
+
+    starProgram_.id = CreateProgram(STAR_VERTEX_SHADER, FRAGMENT_SHADER, reflection);
+    if (starProgram_.id == PROGRAM_ERROR) {
+        return false;
+    }
+    starProgram_.position = reflection.Attribute(POSITION_NAME);
+    starProgram_.transform = reflection.Attribute(TRANSFORM_NAME);
+    starProgram_.style = reflection.Attribute(STYLE_NAME);
+    starProgram_.draw = reflection.Uniform(DRAW_PARAMS_NAME);
+    starProgram_.styleBlock = reflection.UniformBlock(STYLE_BLOCK_NAME);
+    if (starProgram_.styleBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(starProgram_.id, starProgram_.styleBlock, STYLE_BLOCK_BINDING);
+    }
+    starProgram_.viewBlock = reflection.UniformBlock(VIEW_BLOCK_NAME);
+    if (starProgram_.viewBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(starProgram_.id, starProgram_.viewBlock, VIEW_BLOCK_BINDING);
+    }
+
+    layerProgram_.id = CreateProgram(LAYER_VERTEX_SHADER, LAYER_FRAGMENT_SHADER, reflection);
+    if (layerProgram_.id == PROGRAM_ERROR) {
+        return false;
+    }
+    layerProgram_.position = reflection.Attribute(POSITION_NAME);
+    layerProgram_.draw = reflection.Uniform(DRAW_PARAMS_NAME);
+    layerProgram_.texture = reflection.Uniform(TEXTURE_NAME);
+    if (layerProgram_.texture != POSITION_ERROR) {
+        stateCache_->UseProgram(layerProgram_.id);
+        glUniform1i(layerProgram_.texture, 0);
+    }
+
+    return (layerProgram_.position != POSITION_ERROR) && (layerProgram_.draw != POSITION_ERROR) &&
+        (layerProgram_.texture != POSITION_ERROR) &&
+        (colorProgram_.position != POSITION_ERROR) && (colorProgram_.color != POSITION_ERROR) &&
+        (colorProgram_.draw != POSITION_ERROR) && (colorProgram_.viewBlock != GL_INVALID_INDEX) &&
+        (starProgram_.draw != POSITION_ERROR) &&
+        (starProgram_.position != POSITION_ERROR) && (starProgram_.transform != POSITION_ERROR) &&
+        (starProgram_.style != POSITION_ERROR) && (starProgram_.styleBlock != GL_INVALID_INDEX) &&
+        (starProgram_.viewBlock != GL_INVALID_INDEX);
+}
+
+void EGLCore::Background()
+{
+    // The pattern stays in the scene, only hidden, so Draw() merely shows it again.
+    scene_.SetVisible(patternNode_, false);
+    if (RenderFrame() == FrameResult::FAILED) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Background RenderFrame failed");
+    }
 }
 
 void EGLCore::Draw(int& hasDraw)
 {
     flag_ = false;
     OH_LOG_Print(LOG_APP, LOG_INFO, LOG_PRINT_DOMAIN, "EGLCore", "Draw");
-    GLint position = PrepareDraw();
-    if (position == POSITION_ERROR) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Draw get position failed");
+    SetStyleColor(DEFAULT_STAR_STYLE, DRAW_COLOR);
+    scene_.SetVisible(patternNode_, true);
+    FrameResult result = RenderFrame();
+    if (result == FrameResult::FAILED) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Draw RenderFrame failed");
         return;
     }
+    // The pattern is in the scene either way, but ArkTS only hears about it once it is shown.
+    if (result == FrameResult::DEFERRED) {
+        drawDeferred_ = true;
+    } else {
+        hasDraw = 1;
+    }
 
-    if (!ExecuteDraw(position, BACKGROUND_COLOR,
-                     BACKGROUND_RECTANGLE_VERTICES, sizeof(BACKGROUND_RECTANGLE_VERTICES))) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Draw execute draw background failed");
+    flag_ = true;
+}
+
+void EGLCore::ChangeColor(int& hasChangeColor)
+{
+    if (!flag_) {
         return;
     }
+    OH_LOG_Print(LOG_APP, LOG_INFO, LOG_PRINT_DOMAIN, "EGLCore", "ChangeColor");
+    // Only the 16-byte style color changes; instances and mesh stay on the GPU.
+    SetStyleColor(DEFAULT_STAR_STYLE, CHANGE_COLOR);
+    FrameResult result = RenderFrame();
+    if (result == FrameResult::FAILED) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "ChangeColor RenderFrame failed");
+        return;
+    }
+    if (result == FrameResult::DEFERRED) {
+        changeColorDeferred_ = true;
+    } else {
+        hasChangeColor = 1;
+    }
+}
 
-    // Divided into five quadrilaterals and calculate one of the quadrilateral's Vertices
-    GLfloat rotateX = 0;
-    GLfloat rotateY = FIFTY_PERCENT * height_;
-    GLfloat centerX = 0;
-    // Convert DEG(54° & 18°) to RAD
-    GLfloat centerY = -rotateY * (M_PI / 180 * 54) * (M_PI / 180 * 18);
-    // Convert DEG(18°) to RAD
-    GLfloat leftX = -rotateY * (M_PI / 180 * 18);
-    GLfloat leftY = 0;
-    // Convert DEG(18°) to RAD
-    GLfloat rightX = rotateY * (M_PI / 180 * 18);
-    GLfloat rightY = 0;
-
-    const GLfloat shapeVertices[] = { centerX / width_, centerY / height_, leftX / width_, leftY / height_,
-        rotateX / width_, rotateY / height_, rightX / width_, rightY / height_ };
-
-    if (!ExecuteDrawStar(position, DRAW_COLOR, shapeVertices, sizeof(shapeVertices))) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Draw execute draw shape failed");
+void EGLCore::TakeDeferred(int& hasDraw, int& hasChangeColor)
+{
+    if (!HasSurface() || frameBlocked_) {
         return;
     }
+    if (drawDeferred_) {
+        hasDraw = 1;
+    }
+    if (changeColorDeferred_) {
+        hasChangeColor = 1;
+    }
+    drawDeferred_ = false;
+    changeColorDeferred_ = false;
+}
 
-    // Convert DEG(72°) to RAD
-    GLfloat rad = M_PI / 180 * 72;
-    // Rotate four times
-    for (int i = 0; i < NUM_4; ++i) {
-        Rotate2d(centerX, centerY, &rotateX, &rotateY, rad);
-        Rotate2d(centerX, centerY, &leftX, &leftY, rad);
-        Rotate2d(centerX, centerY, &rightX, &rightY, rad);
+void EGLCore::RetryFrame(int& hasDraw, int& hasChangeColor)
+{
+    if (RenderFrame() == FrameResult::FAILED) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "RetryFrame RenderFrame failed");
+        return;
+    }
+    TakeDeferred(hasDraw, hasChangeColor);
+}
 
-        const GLfloat shapeVertices[] = { centerX / width_, centerY / height_, leftX / width_, leftY / height_,
-            rotateX / width_, rotateY / height_, rightX / width_, rightY / height_ };
+bool EGLCore::NeedsFrame() const
+{
+    // Anything that can change pixels on screen; shapes presented last frame have to be
+    // erased even if none are queued now.
+    return scene_.Dirty() || (styleDirtyBegin_ < styleDirtyEnd_) || viewDirty_ || !damage_.Empty() ||
+        !batcher_.FrameEmpty() || !shapeBounds_.Empty();
+}
 
-        if (!ExecuteDrawStar(position, DRAW_COLOR, shapeVertices, sizeof(shapeVertices))) {
-            OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Draw execute draw shape failed");
-            return;
-        }
+FrameResult EGLCore::RenderFrame()
+{
+    frameBlocked_ = false;
+    // Unchanged content: the last present is still correct, so the GPU stays idle and
+    // nothing is swapped.
+    if (!NeedsFrame()) {
+        ++skippedFrames_;
+        return FrameResult::UNCHANGED;
+    }
+    // Detached: changes stay pending in the scene and are presented by AttachSurface().
+    if (!HasSurface()) {
+        return FrameResult::DEFERRED;
+    }
+    if (!PrepareDraw()) {
+        return FrameResult::FAILED;
     }
+    // This frame reuses the oldest slot's ring regions and fence; drawing while the GPU may
+    // still read them would break the frames-in-flight bound. Changes stay pending.
+    if (!WaitFrameSlot()) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "RenderFrame: frame slot still in flight");
+        frameBlocked_ = true;
+        return FrameResult::DEFERRED;
+    }
+    // Re-evaluates only the dirty parts of the scene.
+    SyncScene();
+    if (!scene_.Stars().empty() && !DrawStars()) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "RenderFrame draw stars failed");
+        return FrameResult::FAILED;
+    }
+    return FinishDraw() ? FrameResult::PRESENTED : FrameResult::FAILED;
+}
 
-    if (!FinishDraw()) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Draw FinishDraw failed");
-        return;
+bool EGLCore::CreateGeometry()
+{
+    // Vertex arrays are not shared between contexts; only the buffers they point at are.
+    glGenVertexArrays(1, &starVao_);
+    glGenBuffers(1, &starInstanceVbo_);
+    glGenBuffers(1, &styleUbo_);
+    glGenBuffers(1, &viewUbo_);
+    glGenVertexArrays(1, &layerVao_);
+    if ((starVao_ == 0) || (starInstanceVbo_ == 0) || (styleUbo_ == 0) || (viewUbo_ == 0) || (layerVao_ == 0)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "CreateGeometry: unable to create buffers");
+        DestroyGeometry();
+        return false;
     }
-    hasDraw = 1;
 
-    flag_ = true;
+    // The gl function has no return value.
+    stateCache_->BindVertexArray(starVao_);
+    stateCache_->BindBuffer(GL_ARRAY_BUFFER, starMeshVbo_);
+    stateCache_->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, starIndexBuffer_);
+    glVertexAttribPointer(starProgram_.position, VEC2_SIZE, GL_FLOAT, GL_FALSE, 0, nullptr);
+    stateCache_->EnableVertexAttribArray(starProgram_.position);
+
+    // One StarInstance per star; the whole star mesh is repeated per instance.
+    stateCache_->BindBuffer(GL_ARRAY_BUFFER, starInstanceVbo_);
+    glVertexAttribPointer(starProgram_.transform, VEC4_SIZE, GL_FLOAT, GL_FALSE, sizeof(StarInstance),
+                          reinterpret_cast<const void*>(offsetof(StarInstance, centerX)));
+    glVertexAttribDivisor(starProgram_.transform, 1);
+    stateCache_->EnableVertexAttribArray(starProgram_.transform);
+    glVertexAttribIPointer(starProgram_.style, 1, GL_UNSIGNED_INT, sizeof(StarInstance),
+                           reinterpret_cast<const void*>(offsetof(StarInstance, style)));
+    glVertexAttribDivisor(starProgram_.style, 1);
+    stateCache_->EnableVertexAttribArray(starProgram_.style);
+
+    // Cached layers are composited as one full-surface quad.
+    stateCache_->BindVertexArray(layerVao_);
+    stateCache_->BindBuffer(GL_ARRAY_BUFFER, layerQuadVbo_);
+    glVertexAttribPointer(layerProgram_.position, VEC2_SIZE, GL_FLOAT, GL_FALSE, 0, nullptr);
+    stateCache_->EnableVertexAttribArray(layerProgram_.position);
+
+    stateCache_->BindVertexArray(0);
+
+    // Styles live in one uniform buffer; changes upload only the dirty range.
+    stateCache_->BindBuffer(GL_UNIFORM_BUFFER, styleUbo_);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(styles_), styles_, GL_DYNAMIC_DRAW);
+    stateCache_->BindUniformBufferBase(STYLE_BLOCK_BINDING, styleUbo_);
+    styleDirtyBegin_ = MAX_STYLES;
+    styleDirtyEnd_ = 0;
+
+    // One view-projection for every program; rewritten only when the size or view changes.
+    stateCache_->BindBuffer(GL_UNIFORM_BUFFER, viewUbo_);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(viewProjection_), viewProjection_, GL_DYNAMIC_DRAW);
+    stateCache_->BindUniformBufferBase(VIEW_BLOCK_BINDING, viewUbo_);
+    viewDirty_ = false;
+
+    starInstanceCapacity_ = 0;
+    MarkInstancesDirty(0, UINT32_MAX);
+    geometryReady_ = true;
+    return true;
 }
 
-void EGLCore::ChangeColor(int& hasChangeColor)
+void EGLCore::CreateScene()
 {
-    if (!flag_) {
+    // root -> pattern -> { default star, custom stars }; the entry points only flip
+    // visibility and styles, the scene decides what has to be redrawn. The pattern rarely
+    // changes between frames, so its stars are composited from a cached layer.
+    patternNode_ = scene_.CreateNode(scene_.Root());
+    scene_.SetCacheable(patternNode_, true);
+    defaultStarNode_ = scene_.CreateNode(patternNode_);
+}
+
+void EGLCore::UpdateDefaultStar()
+{
+    if (height_ <= 0) {
         return;
     }
-    OH_LOG_Print(LOG_APP, LOG_INFO, LOG_PRINT_DOMAIN, "EGLCore", "ChangeColor");
-    GLint position = PrepareDraw();
-    if (position == POSITION_ERROR) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "ChangeColor get position failed");
+    // Same footprint as the original pattern: tip at a quarter of the height above center.
+    SceneTransform transform = { 0, DEFAULT_STAR_CENTER_Y * height_, 0, 1.0f };
+    scene_.SetTransform(defaultStarNode_, transform);
+    scene_.SetStar(defaultStarNode_, DEFAULT_STAR_RADIUS * height_, DEFAULT_STAR_STYLE);
+}
+
+void EGLCore::SetStars(const StarInstance* stars, size_t count)
+{
+    for (SceneNodeId node : customStarNodes_) {
+        scene_.DestroyNode(node);
+    }
+    customStarNodes_.clear();
+    bool custom = (stars != nullptr) && (count > 0);
+    scene_.SetVisible(defaultStarNode_, !custom);
+    if (!custom) {
         return;
     }
+    customStarNodes_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const StarInstance& star = stars[i];
+        SceneNodeId node = scene_.CreateNode(patternNode_);
+        SceneTransform transform = { star.centerX, star.centerY, star.rotation, 1.0f };
+        scene_.SetTransform(node, transform);
+        // Out-of-range indices would read past the uniform array in the shader.
+        scene_.SetStar(node, star.radius, (star.style < MAX_STYLES) ? star.style : DEFAULT_STAR_STYLE);
+        customStarNodes_.push_back(node);
+    }
+}
 
-    if (!ExecuteDraw(position, BACKGROUND_COLOR,
-                     BACKGROUND_RECTANGLE_VERTICES, sizeof(BACKGROUND_RECTANGLE_VERTICES))) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "ChangeColor execute draw background failed");
+void EGLCore::SyncScene()
+{
+    // Every star hangs off the pattern node, so its hint decides for the whole star layer.
+    bool cached = scene_.Cacheable(patternNode_);
+    if (cached != starLayerCached_) {
+        starLayerCached_ = cached;
+        if (!cached) {
+            layerCache_.Release(STAR_LAYER);
+        }
+    }
+    if (!scene_.Dirty()) {
         return;
     }
+    SceneUpdate update = scene_.Update();
+    if (update.countChanged) {
+        // The instance count is baked into the recorded star pass.
+        starBundle_.Invalidate();
+        MarkInstancesDirty(0, UINT32_MAX);
+    } else {
+        MarkInstancesDirty(update.dirtyBegin, update.dirtyEnd);
+    }
+}
 
-    // Divided into five quadrilaterals and calculate one of the quadrilateral's Vertices
-    GLfloat rotateX = 0;
-    GLfloat rotateY = FIFTY_PERCENT * height_;
-    GLfloat centerX = 0;
-    // Convert DEG(54° & 18°) to RAD
-    GLfloat centerY = -rotateY * (M_PI / 180 * 54) * (M_PI / 180 * 18);
-    // Convert DEG(18°) to RAD
-    GLfloat leftX = -rotateY * (M_PI / 180 * 18);
-    GLfloat leftY = 0;
-    // Convert DEG(18°) to RAD
-    GLfloat rightX = rotateY * (M_PI / 180 * 18);
-    GLfloat rightY = 0;
-
-    const GLfloat shapeVertices[] = { centerX / width_, centerY / height_, leftX / width_, leftY / height_,
-        rotateX / width_, rotateY / height_, rightX / width_, rightY / height_ };
-
-    if (!ExecuteDrawNewStar(0, CHANGE_COLOR, shapeVertices, sizeof(shapeVertices))) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Draw execute draw shape failed");
+void EGLCore::MarkInstancesDirty(uint32_t begin, uint32_t end)
+{
+    if (begin >= end) {
         return;
     }
+    instanceDirtyBegin_ = std::min(instanceDirtyBegin_, begin);
+    instanceDirtyEnd_ = std::max(instanceDirtyEnd_, end);
+}
 
-    // Convert DEG(72°) to RAD
-    GLfloat rad = M_PI / 180 * 72;
-    // Rotate four times
-    for (int i = 0; i < NUM_4; ++i) {
-        Rotate2d(centerX, centerY, &rotateX, &rotateY, rad);
-        Rotate2d(centerX, centerY, &leftX, &leftY, rad);
-        Rotate2d(centerX, centerY, &rightX, &rightY, rad);
-        const GLfloat shapeVertices[] = { centerX / width_, centerY / height_, leftX / width_, leftY / height_,
-            rotateX / width_, rotateY / height_, rightX / width_, rightY / height_ };
+void EGLCore::ResetTransforms()
+{
+    memcpy(projection_, IDENTITY_MATRIX, sizeof(projection_));
+    memcpy(view_, IDENTITY_MATRIX, sizeof(view_));
+    memcpy(viewProjection_, IDENTITY_MATRIX, sizeof(viewProjection_));
+    viewDirty_ = true;
+}
 
-        if (!ExecuteDrawNewStar(position, CHANGE_COLOR, shapeVertices, sizeof(shapeVertices))) {
-            OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Draw execute draw shape failed");
-            return;
-        }
+void EGLCore::ResetStyles()
+{
+
+    for (uint32_t i = 0; i < MAX_STYLES; ++i) {
+        memcpy(styles_[i].transform, IDENTITY_MATRIX, sizeof(styles_[i].transform));
+        memcpy(styles_[i].color, DRAW_COLOR, sizeof(styles_[i].color));
     }
+    styleDirtyBegin_ = 0;
+    styleDirtyEnd_ = MAX_STYLES;
+}
 
-    if (!FinishDraw()) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "ChangeColor FinishDraw failed");
+void EGLCore::MarkStyleDirty(uint32_t index)
+{
+    if (index < styleDirtyBegin_) {
+        styleDirtyBegin_ = index;
+    }
+    if (index + 1 > styleDirtyEnd_) {
+        styleDirtyEnd_ = index + 1;
     }
-    hasChangeColor = 1;
 }
 
-GLint EGLCore::PrepareDraw()
+void EGLCore::SetStyleColor(uint32_t index, const GLfloat color[4])
 {
-    if ((eglDisplay_ == nullptr) || (eglSurface_ == nullptr) || (eglContext_ == nullptr) ||
-        (!eglMakeCurrent(eglDisplay_, eglSurface_, eglSurface_, eglContext_))) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "PrepareDraw: param error");
-        return POSITION_ERROR;
+    if ((index >= MAX_STYLES) || (color == nullptr)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "SetStyleColor: param error");
+        return;
     }
+    if (memcmp(styles_[index].color, color, sizeof(styles_[index].color)) == 0) {
+        return;
+    }
+    memcpy(styles_[index].color, color, sizeof(styles_[index].color));
+    MarkStyleDirty(index);
+    // Colors decide whether the star pass blends; transforms live in the uniform block only.
+    starBundle_.Invalidate();
+}
 
-    // The gl function has no return value.
-    glViewport(DEFAULT_X_POSITION, DEFAULT_Y_POSITION, width_, height_);
-    glClearColor(GL_RED_DEFAULT, GL_GREEN_DEFAULT, GL_BLUE_DEFAULT, GL_ALPHA_DEFAULT);
-    glClear(GL_COLOR_BUFFER_BIT);
-    glUseProgram(program_);
+void EGLCore::SetStyleTransform(uint32_t index, const GLfloat transform[16])
+{
+    if ((index >= MAX_STYLES) || (transform == nullptr)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "SetStyleTransform: param error");
+        return;
+    }
+    if (memcmp(styles_[index].transform, transform, sizeof(styles_[index].transform)) == 0) {
+        return;
+    }
+    memcpy(styles_[index].transform, transform, sizeof(styles_[index].transform));
+    MarkStyleDirty(index);
+}
 
-    return glGetAttribLocation(program_, POSITION_NAME);
+void EGLCore::UploadStyles()
+{
+    if (styleDirtyBegin_ >= styleDirtyEnd_) {
+        return;
+    }
+    // The gl function has no return value.
+    stateCache_->BindBuffer(GL_UNIFORM_BUFFER, styleUbo_);
+    glBufferSubData(GL_UNIFORM_BUFFER, styleDirtyBegin_ * sizeof(DrawStyle),
+                    (styleDirtyEnd_ - styleDirtyBegin_) * sizeof(DrawStyle), &styles_[styleDirtyBegin_]);
+    styleDirtyBegin_ = MAX_STYLES;
+    styleDirtyEnd_ = 0;
 }
 
-bool EGLCore::ExecuteDraw(GLint position, const GLfloat* color, const GLfloat shapeVertices[], unsigned long vertSize)
+bool EGLCore::DrawStars()
 {
-    if ((position > 0) || (color == nullptr) || (vertSize / sizeof(shapeVertices[0])) != SHAPE_VERTICES_SIZE) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "ExecuteDraw: param error");
+    const std::vector<StarInstance>& stars = scene_.Stars();
+    if (!geometryReady_ || stars.empty()) {
         return false;
     }
+    // Anything that reaches the GPU below changes what the stars look like.
+    bool changed = !starBundle_.Valid() || (instanceDirtyBegin_ < instanceDirtyEnd_) ||
+        (styleDirtyBegin_ < styleDirtyEnd_);
+    if (changed || !starsPresented_) {
+        damage_.Add(starBounds_);
+        starBounds_ = StarBounds();
+        damage_.Add(starBounds_);
+    }
+    starsDrawn_ = true;
+    UploadStyles();
 
     // The gl function has no return value.
-    glVertexAttribPointer(position, POINTER_SIZE, GL_FLOAT, GL_FALSE, 0, shapeVertices);
-    glEnableVertexAttribArray(position);
-    glVertexAttrib4fv(1, color);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, TRIANGLE_FAN_SIZE);
-    glDisableVertexAttribArray(position);
+    // Only the instances the scene rewrote are uploaded.
+    uint32_t dirtyEnd = std::min(instanceDirtyEnd_, static_cast<uint32_t>(stars.size()));
+    if (instanceDirtyBegin_ < dirtyEnd) {
+        stateCache_->BindBuffer(GL_ARRAY_BUFFER, starInstanceVbo_);
+        if (stars.size() > starInstanceCapacity_) {
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(stars.size() * sizeof(StarInstance)), stars.data(),
+                         GL_DYNAMIC_DRAW);
+            starInstanceCapacity_ = stars.size();
+        } else {
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(instanceDirtyBegin_ * sizeof(StarInstance)),
+                            static_cast<GLsizeiptr>((dirtyEnd - instanceDirtyBegin_) * sizeof(StarInstance)),
+                            &stars[instanceDirtyBegin_]);
+        }
+    }
+    instanceDirtyBegin_ = UINT32_MAX;
+    instanceDirtyEnd_ = 0;
+
+    // The recorded pass only changes with the instances, style colors or size.
+    if (!starBundle_.Valid()) {
+        RecordStars();
+    }
+    if (!starLayerCached_) {
+        return starBundle_.Replay(drawList_) > 0;
+    }
 
+    if (changed) {
+        layerCache_.Invalidate(STAR_LAYER);
+    }
+    CachedLayer* layer = layerCache_.Acquire(STAR_LAYER, width_, height_);
+    if (layer == nullptr) {
+        // Over the layer budget: draw the stars directly.
+        return starBundle_.Replay(drawList_) > 0;
+    }
+    if (!layer->valid && !RenderLayer(*layer, starBundle_)) {
+        return false;
+    }
+    CompositeLayer(*layer, STAR_LAYER, STAR_LAYER_COMPOSITE_DEPTH);
     return true;
 }
 
-bool EGLCore::ExecuteDrawStar(
-    GLint position, const GLfloat* color, const GLfloat shapeVertices[], unsigned long vertSize)
+bool EGLCore::RenderLayer(CachedLayer& layer, const CommandList& content)
 {
-    if ((position > 0) || (color == nullptr) || (vertSize / sizeof(shapeVertices[0])) != SHAPE_VERTICES_SIZE) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "ExecuteDraw: param error");
+    content.Replay(layerList_);
+    layerList_.Sort();
+    if (!layerCache_.BeginRender(layer)) {
+        layerList_.Clear();
         return false;
     }
+    layerList_.Submit(*stateCache_);
+    layerList_.Clear();
+    layerCache_.EndRender(layer);
+    stateCache_->Viewport(DEFAULT_X_POSITION, DEFAULT_Y_POSITION, width_, height_);
+    return true;
+}
 
-    // The gl function has no return value.
-    glVertexAttribPointer(position, POINTER_SIZE, GL_FLOAT, GL_FALSE, 0, shapeVertices);
-    glVertexAttribPointer(1, POINTER_SIZE, GL_FLOAT, GL_FALSE, 0, color);
-    glEnableVertexAttribArray(position);
-    glEnableVertexAttribArray(1);
-    glVertexAttrib4fv(1, color);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, TRIANGLE_FAN_SIZE);
-    glDisableVertexAttribArray(position);
-    glDisableVertexAttribArray(1);
+void EGLCore::CompositeLayer(const CachedLayer& layer, uint8_t order, GLfloat depth)
+{
+    DrawCommand command = {};
+    command.program = layerProgram_.id;
+    command.vertexArray = layerVao_;
+    command.texture = layer.texture;
+    command.mode = GL_TRIANGLE_STRIP;
+    command.count = LAYER_QUAD_VERTICES;
+    command.indexType = GL_NONE;
+    command.instances = 1;
+    command.blend = true;
+    command.premultiplied = true;
+    command.drawUniform = layerProgram_.draw;
+    command.drawParams[0] = depth;
+    command.drawParams[1] = static_cast<GLfloat>(layer.width) / layer.storageWidth;
+    command.drawParams[2] = static_cast<GLfloat>(layer.height) / layer.storageHeight;
+    drawList_.Add(DrawList::MakeKey(order, layerProgram_.id, layer.texture, true, depth), command);
+}
 
+void EGLCore::SetLayerCacheBudget(size_t budgetBytes)
+{
+    layerCache_.SetBudget(budgetBytes);
+}
+
+bool EGLCore::BenchmarkShapes(VertexFormat format, uint32_t frames, uint32_t shapeCount, ShapeBenchmark& result)
+{
+    if (!HasSurface() || (frames == 0) || (shapeCount == 0)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "BenchmarkShapes: param error");
+        return false;
+    }
+    VertexFormat previousFormat = batcher_.Format();
+    GLfloat previousExtent = batcher_.Extent();
+    if (!batcher_.SetVertexFormat(format)) {
+        return false;
+    }
+    // Same grid of stars for every format, so only the packing differs.
+    const ShapeMesh mesh = Pentagram::Mesh();
+    uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(shapeCount))));
+    GLfloat cell = static_cast<GLfloat>(std::min(width_, height_)) / static_cast<GLfloat>(columns);
+    GLfloat origin = -cell * static_cast<GLfloat>(columns) * FIFTY_PERCENT;
+    batcher_.TakeStats();
+    uint64_t bytes = 0;
+    bool drawn = true;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; drawn && (frame < frames); ++frame) {
+        for (uint32_t i = 0; i < shapeCount; ++i) {
+            GLfloat x = origin + (static_cast<GLfloat>(i % columns) + FIFTY_PERCENT) * cell;
+            GLfloat y = origin + (static_cast<GLfloat>(i / columns) + FIFTY_PERCENT) * cell;
+            batcher_.AddMesh(mesh, x, y, cell * BENCHMARK_STAR_SCALE, DRAW_COLOR);
+        }
+        drawn = (RenderFrame() == FrameResult::PRESENTED);
+        bytes += batcher_.TakeStats().bytes;
+    }
+    // Frames are only done once the GPU is; the CPU side alone would favour no format.
+    DrainFrameFences();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    batcher_.SetVertexFormat(previousFormat, previousExtent);
+    // Erases the stars again; the scene itself was never touched.
+    RenderFrame();
+    if (!drawn) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "BenchmarkShapes: frame failed");
+        return false;
+    }
+    result = {format, frames, bytes / frames, elapsed.count() / frames};
     return true;
 }
 
-bool EGLCore::ExecuteDrawNewStar(
-    GLint position, const GLfloat* color, const GLfloat shapeVertices[], unsigned long vertSize)
+void EGLCore::RecordStars()
+{
+    const std::vector<StarInstance>& stars = scene_.Stars();
+    // Star layer depths lie in (0, 1), behind batched shapes; later instances are in front.
+    GLfloat depthStep = 1.0f / static_cast<GLfloat>(stars.size() + 1);
+    bool translucent = false;
+    for (const StarInstance& star : stars) {
+        if (styles_[star.style].color[3] < 1.0f) {
+            translucent = true;
+            break;
+        }
+    }
+    DrawCommand command = {};
+    command.program = starProgram_.id;
+    command.vertexArray = starVao_;
+    command.mode = GL_TRIANGLES;
+    command.count = static_cast<GLsizei>(StarShape::Tables::INDEX_COUNT);
+    command.indexType = GL_UNSIGNED_SHORT;
+    command.instances = static_cast<GLsizei>(stars.size());
+    command.blend = translucent;
+    command.drawUniform = starProgram_.draw;
+    command.drawParams[0] = 1.0f - depthStep;
+    command.drawParams[1] = depthStep;
+    GLfloat nearest = 1.0f - depthStep * stars.size();
+    GLfloat farthest = 1.0f - depthStep;
+    starBundle_.Begin();
+    starBundle_.Add(DrawList::MakeKey(STAR_LAYER, starProgram_.id, 0, translucent, translucent ? farthest : nearest),
+                    command);
+    starBundle_.End();
+}
+
+void EGLCore::DestroyGeometry()
+{
+    geometryReady_ = false;
+    starBundle_.Invalidate();
+    stateCache_->OnVertexArrayDeleted(starVao_);
+    stateCache_->OnBufferDeleted(starInstanceVbo_);
+    stateCache_->OnBufferDeleted(styleUbo_);
+    stateCache_->OnBufferDeleted(viewUbo_);
+    stateCache_->OnVertexArrayDeleted(layerVao_);
+    glDeleteVertexArrays(1, &starVao_);
+    glDeleteBuffers(1, &starInstanceVbo_);
+    glDeleteBuffers(1, &styleUbo_);
+    glDeleteBuffers(1, &viewUbo_);
+    glDeleteVertexArrays(1, &layerVao_);
+    // The mesh buffers belong to the shared resources and stay alive.
+    layerVao_ = 0;
+    layerQuadVbo_ = 0;
+    starVao_ = 0;
+    starMeshVbo_ = 0;
+    starIndexBuffer_ = 0;
+    starInstanceVbo_ = 0;
+    styleUbo_ = 0;
+    viewUbo_ = 0;
+    starInstanceCapacity_ = 0;
+}
+
+bool EGLCore::PrepareDraw()
 {
-    if ((position > 0) || (color == nullptr) || (vertSize / sizeof(shapeVertices[0])) != SHAPE_VERTICES_SIZE) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "ExecuteDraw: param error");
+    if ((context_ == nullptr) || !context_->MakeCurrent(eglSurface_)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "PrepareDraw: param error");
         return false;
     }
 
+    // Redundant state changes are filtered by the state cache. The window surface is
+    // cleared in FinishDraw(), once the frame's damage is known.
+    stateCache_->Viewport(DEFAULT_X_POSITION, DEFAULT_Y_POSITION, width_, height_);
+    // Binding points belong to the shared context; other surfaces bind their own blocks.
+    stateCache_->BindUniformBufferBase(STYLE_BLOCK_BINDING, styleUbo_);
+    stateCache_->BindUniformBufferBase(VIEW_BLOCK_BINDING, viewUbo_);
+    UploadView();
+    return true;
+}
+
+bool EGLCore::FinishDraw()
+{
+    batcher_.Flush();
+    TrackShapeDamage();
+    if (starsPresented_ && !starsDrawn_) {
+        damage_.Add(starBounds_);
+    }
+    starsPresented_ = starsDrawn_;
+    starsDrawn_ = false;
+
+    // Nothing changed on screen: the front buffer is already correct.
+    bool presented = true;
+    if (!damage_.Empty()) {
+        DamageRect region = BeginDamagedFrame();
+        // Everything recorded this frame is sorted by state and depth, then submitted at once.
+        drawList_.Sort();
+        drawList_.Submit(*stateCache_);
+        stateCache_->Disable(GL_SCISSOR_TEST);
+        presented = SwapWithDamage(region);
+        damage_.EndFrame();
+    }
+    drawList_.Clear();
+    batcher_.EndFrame();
+    ringBuffer_.EndFrame();
+
+    // Fence this frame instead of glFinish(); the CPU only blocks in WaitFrameSlot() once
+    // framesInFlight_ frames are queued on the GPU. eglSwapBuffers() flushes implicitly.
+    uint32_t slot = frameIndex_ % framesInFlight_;
+    frameFences_[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++frameIndex_;
+    return presented;
+}
+
+DamageRect EGLCore::BeginDamagedFrame()
+{
+    // The back buffer keeps the frame it showed bufferAge presents ago; only the damage
+    // since then needs to be redrawn.
+    EGLint bufferAge = 0;
+    if (bufferAgeSupported_ && !eglQuerySurface(context_->Display(), eglSurface_, EGL_BUFFER_AGE_EXT, &bufferAge)) {
+        bufferAge = 0;
+    }
+    DamageRect region = damage_.Resolve(bufferAge);
+    if (partialUpdateSupported_) {
+        EGLint rect[] = { region.x, region.y, region.width, region.height };
+        eglSetDamageRegionKHR(context_->Display(), eglSurface_, rect, 1);
+    }
+
     // The gl function has no return value.
-    glVertexAttribPointer(position, POINTER_SIZE, GL_FLOAT, GL_FALSE, 0, shapeVertices);
-    glEnableVertexAttribArray(position);
-    glVertexAttrib4fv(1, color);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, TRIANGLE_FAN_SIZE);
-    glDisableVertexAttribArray(position);
+    if (damage_.IsFull(region)) {
+        stateCache_->Disable(GL_SCISSOR_TEST);
+    } else {
+        stateCache_->Enable(GL_SCISSOR_TEST);
+        stateCache_->Scissor(region.x, region.y, region.width, region.height);
+    }
+    // The background is the clear color; nothing else paints the full surface.
+    stateCache_->ClearColor(BACKGROUND_COLOR[0], BACKGROUND_COLOR[1], BACKGROUND_COLOR[2], BACKGROUND_COLOR[3]);
+    stateCache_->DepthMask(GL_TRUE);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    return region;
+}
+
+bool EGLCore::SwapWithDamage(const DamageRect& region)
+{
+    if (!swapWithDamageSupported_ || damage_.IsFull(region)) {
+        return eglSwapBuffers(context_->Display(), eglSurface_);
+    }
+    // Only this frame's damage changed on screen, whatever had to be redrawn into the buffer.
+    DamageRect frame = damage_.Resolve(1);
+    EGLint rect[] = { frame.x, frame.y, frame.width, frame.height };
+    return eglSwapBuffersWithDamageKHR(context_->Display(), eglSurface_, rect, 1);
+}
 
+void EGLCore::TrackShapeDamage()
+{
+    // Streamed shapes are queued anew every frame; both the old and the new area changed.
+    damage_.Add(shapeBounds_);
+    GLfloat bounds[4];
+    shapeBounds_ = batcher_.FrameBounds(bounds) ? ProjectBounds(nullptr, bounds) : DamageRect {};
+    damage_.Add(shapeBounds_);
+}
+
+DamageRect EGLCore::ProjectBounds(const GLfloat* transform, const GLfloat bounds[4]) const
+{
+    GLfloat minX = static_cast<GLfloat>(width_);
+    GLfloat minY = static_cast<GLfloat>(height_);
+    GLfloat maxX = 0;
+    GLfloat maxY = 0;
+    const GLfloat corners[][2] = {
+        { bounds[0], bounds[1] }, { bounds[2], bounds[1] }, { bounds[0], bounds[3] }, { bounds[2], bounds[3] } };
+    for (const GLfloat* corner : corners) {
+        GLfloat point[MATRIX_DIMENSION] = { corner[0], corner[1], 0.0f, 1.0f };
+        if (transform != nullptr) {
+            TransformPoint(transform, point);
+        }
+        TransformPoint(viewProjection_, point);
+        if (point[MATRIX_DIMENSION - 1] <= 0) {
+            // Behind the eye; only a full redraw is safe.
+            return { 0, 0, width_, height_ };
+        }
+        // Clip space to window pixels, origin bottom-left.
+        GLfloat windowX = (point[0] / point[MATRIX_DIMENSION - 1] + 1.0f) * FIFTY_PERCENT * width_;
+        GLfloat windowY = (point[1] / point[MATRIX_DIMENSION - 1] + 1.0f) * FIFTY_PERCENT * height_;
+        minX = std::min(minX, windowX);
+        minY = std::min(minY, windowY);
+        maxX = std::max(maxX, windowX);
+        maxY = std::max(maxY, windowY);
+    }
+    GLint left = static_cast<GLint>(std::floor(minX)) - DAMAGE_MARGIN;
+    GLint bottom = static_cast<GLint>(std::floor(minY)) - DAMAGE_MARGIN;
+    GLint right = static_cast<GLint>(std::ceil(maxX)) + DAMAGE_MARGIN;
+    GLint top = static_cast<GLint>(std::ceil(maxY)) + DAMAGE_MARGIN;
+    return { left, bottom, right - left, top - bottom };
+}
+
+DamageRect EGLCore::StarBounds() const
+{
+    // The unit star fits in the unit circle, so center +/- radius bounds every star.
+    DamageRect bounds = {};
+    for (const StarInstance& star : scene_.Stars()) {
+        GLfloat box[] = { star.centerX - star.radius, star.centerY - star.radius, star.centerX + star.radius,
+                          star.centerY + star.radius };
+        DamageRect rect = ProjectBounds(styles_[star.style].transform, box);
+        if (bounds.Empty()) {
+            bounds = rect;
+        } else if (!rect.Empty()) {
+            GLint right = std::max(bounds.x + bounds.width, rect.x + rect.width);
+            GLint top = std::max(bounds.y + bounds.height, rect.y + rect.height);
+            bounds.x = std::min(bounds.x, rect.x);
+            bounds.y = std::min(bounds.y, rect.y);
+            bounds.width = right - bounds.x;
+            bounds.height = top - bounds.y;
+        }
+    }
+    return bounds;
+}
+
+bool EGLCore::WaitFrameSlot()
+{
+    uint32_t slot = frameIndex_ % framesInFlight_;
+    GLsync fence = frameFences_[slot];
+    if (fence == nullptr) {
+        return true;
+    }
+    GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FRAME_FENCE_TIMEOUT_NS);
+    // A timed-out fence stays in its slot, so the next attempt waits on it again.
+    if (result == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    frameFences_[slot] = nullptr;
+    glDeleteSync(fence);
     return true;
 }
 
-void EGLCore::Rotate2d(GLfloat centerX, GLfloat centerY, GLfloat* rotateX, GLfloat* rotateY, GLfloat theta)
+void EGLCore::DrainFrameFences()
 {
-    GLfloat tempX = cos(theta) * (*rotateX - centerX) - sin(theta) * (*rotateY - centerY);
-    GLfloat tempY = sin(theta) * (*rotateX - centerX) + cos(theta) * (*rotateY - centerY);
-    *rotateX = tempX + centerX;
-    *rotateY = tempY + centerY;
+    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        if (frameFences_[i] == nullptr) {
+            continue;
+        }
+        glClientWaitSync(frameFences_[i], GL_SYNC_FLUSH_COMMANDS_BIT, FRAME_FENCE_TIMEOUT_NS);
+        glDeleteSync(frameFences_[i]);
+        frameFences_[i] = nullptr;
+    }
+    frameIndex_ = 0;
 }
 
-bool EGLCore::FinishDraw()
+void EGLCore::SetFramesInFlight(int framesInFlight)
 {
-    // The gl function has no return value.
-    glFlush();
-    glFinish();
-    return eglSwapBuffers(eglDisplay_, eglSurface_);
+    if ((framesInFlight < 1) || (framesInFlight > MAX_FRAMES_IN_FLIGHT)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "SetFramesInFlight: param error");
+        return;
+    }
+    // Slots beyond the new count would never be waited on again; a detached core drains
+    // through the surfaceless context, or has nothing left since DetachSurface() drained.
+    if ((context_ != nullptr) && context_->MakeCurrent(eglSurface_)) {
+        DrainFrameFences();
+    }
+    framesInFlight_ = framesInFlight;
 }
 
 GLuint EGLCore::LoadShader(GLenum type, const char* shaderSrc)
@@ -549,7 +1284,7 @@ GLuint EGLCore::LoadShader(GLenum type, const char* shaderSrc)
     return PROGRAM_ERROR;
 }
 
-GLuint EGLCore::CreateProgram(const char* vertexShader, const char* fragShader)
+GLuint EGLCore::CreateProgram(const char* vertexShader, const char* fragShader, ProgramInterface& reflection)
 {
     if ((vertexShader == nullptr) || (fragShader == nullptr)) {
         OH_LOG_Print(
@@ -557,6 +1292,13 @@ GLuint EGLCore::CreateProgram(const char* vertexShader, const char* fragShader)
         return PROGRAM_ERROR;
     }
 
+    // A binary from an earlier run skips compilation; anything it rejects is compiled below.
+    GLuint cached = ProgramCache::Instance().Load(vertexShader, fragShader);
+    if (cached != PROGRAM_ERROR) {
+        reflection.Reflect(cached);
+        return cached;
+    }
+
     GLuint vertex = LoadShader(GL_VERTEX_SHADER, vertexShader);
     if (vertex == PROGRAM_ERROR) {
         OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "createProgram vertex error");
@@ -580,6 +1322,7 @@ GLuint EGLCore::CreateProgram(const char* vertexShader, const char* fragShader)
     // The gl function has no return value.
     glAttachShader(program, vertex);
     glAttachShader(program, fragment);
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(program);
 
     GLint linked;
@@ -587,6 +1330,9 @@ GLuint EGLCore::CreateProgram(const char* vertexShader, const char* fragShader)
     if (linked != 0) {
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+        // Reflect once here so draw paths never look locations up by name.
+        reflection.Reflect(program);
+        ProgramCache::Instance().Store(program, vertexShader, fragShader);
         return program;
     }
 
@@ -611,23 +1357,134 @@ void EGLCore::UpdateSize(int width, int height)
 {
     width_ = width;
     height_ = height;
-    if (width_ > 0) {
-        widthPercent_ = FIFTY_PERCENT * height_ / width_;
+    starBundle_.Invalidate();
+    if ((width_ > 0) && (height_ > 0)) {
+        // Pixels relative to the surface center to clip space; vertices are never rewritten.
+        GLfloat halfWidth = FIFTY_PERCENT * width_;
+        GLfloat halfHeight = FIFTY_PERCENT * height_;
+        memcpy(projection_, IDENTITY_MATRIX, sizeof(projection_));
+        projection_[0] = 1.0f / halfWidth;
+        projection_[MATRIX_DIMENSION + 1] = 1.0f / halfHeight;
+        UpdateViewProjection();
     }
+    damage_.Reset(width_, height_);
+    starsPresented_ = false;
+    UpdateDefaultStar();
 }
 
-void EGLCore::Release()
+bool EGLCore::Resize(int width, int height)
+{
+    if ((width <= 0) || (height <= 0)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Resize: param error");
+        return false;
+    }
+    if ((width == width_) && (height == height_)) {
+        return true;
+    }
+    // Projection, viewport and the default star are rewritten in place; GPU objects are
+    // kept and cached layers only reallocate when the size leaves their bucket.
+    UpdateSize(width, height);
+    return RenderFrame() != FrameResult::FAILED;
+}
+
+void EGLCore::SetView(const GLfloat view[16])
+{
+    if (view == nullptr) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "SetView: param error");
+        return;
+    }
+    memcpy(view_, view, sizeof(view_));
+    UpdateViewProjection();
+    damage_.AddFull();
+    starsPresented_ = false;
+    // Layers are rendered with the view baked in.
+    layerCache_.InvalidateAll();
+}
+
+void EGLCore::UpdateViewProjection()
+{
+    // Column major: viewProjection = projection * view.
+    for (int col = 0; col < MATRIX_DIMENSION; ++col) {
+        for (int row = 0; row < MATRIX_DIMENSION; ++row) {
+            GLfloat sum = 0;
+            for (int k = 0; k < MATRIX_DIMENSION; ++k) {
+                sum += projection_[k * MATRIX_DIMENSION + row] * view_[col * MATRIX_DIMENSION + k];
+            }
+            viewProjection_[col * MATRIX_DIMENSION + row] = sum;
+        }
+    }
+    viewDirty_ = true;
+}
+
+void EGLCore::UploadView()
 {
-    if ((eglDisplay_ == nullptr) || (eglSurface_ == nullptr) || (!eglDestroySurface(eglDisplay_, eglSurface_))) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Release eglDestroySurface failed");
+    if (!viewDirty_ || (viewUbo_ == 0)) {
+        return;
+    }
+    // The gl function has no return value.
+    stateCache_->BindBuffer(GL_UNIFORM_BUFFER, viewUbo_);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(viewProjection_), viewProjection_);
+    viewDirty_ = false;
+}
+
+void EGLCore::DetachSurface()
+{
+    if (eglSurface_ == EGL_NO_SURFACE) {
+        return;
+    }
+    // Context, GL objects, scene and cached layers stay; only the window goes away. Frame
+    // fences are retired first so a detached core never holds sync objects it cannot reach.
+    if (context_->MakeCurrent(eglSurface_)) {
+        DrainFrameFences();
     }
+    context_->DestroySurface(eglSurface_);
+    eglSurface_ = EGL_NO_SURFACE;
+    eglWindow_ = nullptr;
+}
 
-    if ((eglDisplay_ == nullptr) || (eglContext_ == nullptr) || (!eglDestroyContext(eglDisplay_, eglContext_))) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Release eglDestroyContext failed");
+bool EGLCore::AttachSurface(void* window, int width, int height)
+{
+    if ((context_ == nullptr) || !context_->Ready() || (window == nullptr) || (width <= 0) || (height <= 0)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "AttachSurface: param error");
+        return false;
+    }
+    DetachSurface();
+    eglWindow_ = static_cast<EGLNativeWindowType>(window);
+    eglSurface_ = context_->CreateWindowSurface(eglWindow_);
+    if (eglSurface_ == EGL_NO_SURFACE) {
+        return false;
+    }
+    // A new surface starts with undefined contents and no buffer age history.
+    if ((width != width_) || (height != height_)) {
+        UpdateSize(width, height);
+    } else {
+        damage_.Reset(width_, height_);
+        starsPresented_ = false;
     }
+    // Nothing is rebuilt, so the retained scene can be presented right away.
+    return RenderFrame() != FrameResult::FAILED;
+}
 
-    if ((eglDisplay_ == nullptr) || (!eglTerminate(eglDisplay_))) {
-        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Release eglTerminate failed");
+void EGLCore::Release()
+{
+    if (context_ == nullptr) {
+        return;
+    }
+    // GL objects live in the shared context; delete them while it is current. A detached
+    // core needs a surfaceless context for that.
+    if (context_->MakeCurrent(eglSurface_)) {
+        DrainFrameFences();
+        DestroyGeometry();
+        layerCache_.Destroy();
+        batcher_.Destroy();
+        ringBuffer_.Destroy();
+        ReleaseSharedResources();
+    } else {
+        // Still counted as a user, so the shared objects stay for the next core or Shutdown().
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLCore", "Release eglMakeCurrent failed");
     }
+    DetachSurface();
+    context_ = nullptr;
+    stateCache_ = nullptr;
 }
 } // namespace NativeXComponentSample
@@ -19,42 +19,281 @@
 #include <EGL/eglext.h>
 #include <GLES3/gl3.h>
 #include "string"
+#include <vector>
+#include "render/command_list.h"
+#include "render/damage_tracker.h"
+#include "render/draw_list.h"
+#include "render/geometry_batcher.h"
+#include "render/gl_state_cache.h"
+#include "render/layer_cache.h"
+#include "render/program_interface.h"
+#include "render/render_context.h"
+#include "render/ring_buffer.h"
+#include "render/scene_graph.h"
 
 namespace NativeXComponentSample {
+/**
+ * One entry of the style uniform block, std140 layout. transform is column major
+ * and applied in pixel space after the instance placement.
+ */
+struct DrawStyle {
+    GLfloat transform[16];
+    GLfloat color[4];
+};
+
+/**
+ * Result of EGLCore::BenchmarkShapes() for one vertex format: vertex and index bytes
+ * streamed and wall time per frame, GPU completion included.
+ */
+struct ShapeBenchmark {
+    VertexFormat format;
+    uint32_t frames;
+    uint64_t bytesPerFrame;
+    double msPerFrame;
+};
+
+/**
+ * Outcome of one frame request. UNCHANGED means the last present is still correct;
+ * DEFERRED means the changes are kept until a surface is attached again, or until the
+ * GPU has released the oldest frame in flight (see EGLCore::FrameBlocked()).
+ */
+enum class FrameResult : uint8_t {
+    PRESENTED,
+    UNCHANGED,
+    DEFERRED,
+    FAILED,
+};
+
 class EGLCore {
 public:
-    explicit EGLCore() {}
+    explicit EGLCore()
+    {
+        ResetTransforms();
+        ResetStyles();
+        CreateScene();
+    }
     ~EGLCore() {}
-    bool EglContextInit(void* window, int width, int height);
+    // Renders to window through the given context; context must be initialized.
+    bool EglContextInit(RenderContext* context, void* window, int width, int height);
     bool CreateEnvironment();
     void Draw(int& hasDraw);
     void Background();
     void ChangeColor(int& hasChangeColor);
     void Release();
+    // Forgets the shared programs and meshes without deleting them, for cores that could not
+    // be released on the render thread; EGLDevice::Shutdown() reclaims the share group.
+    static void AbandonSharedResources();
+    // Surface loss keeps the context, GL objects and scene; only the EGLSurface is destroyed.
+    void DetachSurface();
+    // Binds a new window after DetachSurface() and presents the retained scene.
+    bool AttachSurface(void* window, int width, int height);
+    // Sets the flags of Draw() and ChangeColor() calls whose frame was deferred, once a
+    // later frame has presented them; leaves them pending otherwise.
+    void TakeDeferred(int& hasDraw, int& hasChangeColor);
+    // True when the last frame was put off because the GPU still used the oldest frame
+    // slot; RetryFrame() presents it later without drawing over that frame.
+    bool FrameBlocked() const
+    {
+        return frameBlocked_;
+    }
+    void RetryFrame(int& hasDraw, int& hasChangeColor);
+    bool HasSurface() const
+    {
+        return eglSurface_ != EGL_NO_SURFACE;
+    }
     void UpdateSize(int width, int height);
+    // Live resize: updates the size and presents a frame at it right away.
+    bool Resize(int width, int height);
+    void SetFramesInFlight(int framesInFlight);
+    // Replaces the default star with one scene node per star; null or zero restores it.
+    void SetStars(const StarInstance* stars, size_t count);
+    void SetStyleColor(uint32_t index, const GLfloat color[4]);
+    void SetStyleTransform(uint32_t index, const GLfloat transform[16]);
+    // Column-major view matrix in pixel space, applied to everything on the GPU.
+    void SetView(const GLfloat view[16]);
+    void SetLayerCacheBudget(size_t budgetBytes);
+    // Presents `frames` frames of `shapeCount` batched stars in the given vertex format and
+    // measures them; the previous format is restored afterwards. Needs a surface.
+    bool BenchmarkShapes(VertexFormat format, uint32_t frames, uint32_t shapeCount, ShapeBenchmark& result);
+    const LayerCacheStats& LayerStats() const
+    {
+        return layerCache_.Stats();
+    }
+    // Nodes changed here are re-evaluated with the next frame; render thread only.
+    SceneGraph& Scene()
+    {
+        return scene_;
+    }
+    // Shapes queued here are drawn with the next frame; render thread only.
+    GeometryBatcher& Shapes()
+    {
+        return batcher_;
+    }
+    // Frame requests answered without GPU work because nothing changed.
+    uint64_t SkippedFrames() const
+    {
+        return skippedFrames_;
+    }
+    const RingBufferStats& DynamicBufferStats() const
+    {
+        return ringBuffer_.LastFrameStats();
+    }
+
+    static constexpr int MAX_FRAMES_IN_FLIGHT = 4;
+    static constexpr uint32_t MAX_STYLES = MAX_DRAW_STYLES;
+    static constexpr uint32_t DEFAULT_STAR_STYLE = 0;
 
 private:
     GLuint LoadShader(GLenum type, const char* shaderSrc);
-    GLuint CreateProgram(const char* vertexShader, const char* fragShader);
-    GLint PrepareDraw();
-    bool ExecuteDraw(GLint position, const GLfloat* color, const GLfloat shapeVertices[], unsigned long vertSize);
-    bool ExecuteDrawStar(GLint position, const GLfloat* color, const GLfloat shapeVertices[], unsigned long vertSize);
-    bool ExecuteDrawNewStar(GLint position, const GLfloat* color,
-                            const GLfloat shapeVertices[], unsigned long vertSize);
-    void Rotate2d(GLfloat centerX, GLfloat centerY, GLfloat* rotateX, GLfloat* rotateY, GLfloat theta);
+    GLuint CreateProgram(const char* vertexShader, const char* fragShader, ProgramInterface& reflection);
+    bool AcquireSharedResources();
+    void ReleaseSharedResources();
+    bool CreatePrograms();
+    bool PrepareDraw();
+    bool DrawStars();
+    void RecordStars();
+    bool RenderLayer(CachedLayer& layer, const CommandList& content);
+    void CompositeLayer(const CachedLayer& layer, uint8_t order, GLfloat depth);
+    void ResetTransforms();
+    void ResetStyles();
+    void MarkStyleDirty(uint32_t index);
+    void UploadStyles();
+    void UpdateViewProjection();
+    void UploadView();
+    bool CreateGeometry();
+    void CreateScene();
+    void UpdateDefaultStar();
+    void SyncScene();
+    void MarkInstancesDirty(uint32_t begin, uint32_t end);
+    bool NeedsFrame() const;
+    FrameResult RenderFrame();
+    void DestroyGeometry();
     bool FinishDraw();
+    DamageRect BeginDamagedFrame();
+    bool SwapWithDamage(const DamageRect& region);
+    void TrackShapeDamage();
+    // Window-space bounds of a pixel-space box (minX, minY, maxX, maxY) after transform
+    // (may be null) and the view projection.
+    DamageRect ProjectBounds(const GLfloat* transform, const GLfloat bounds[4]) const;
+    DamageRect StarBounds() const;
+    bool WaitFrameSlot();
+    void DrainFrameFences();
+
+    /**
+     * Typed interface of the flat color program, filled from reflection at link time.
+     */
+    struct ColorProgram {
+        GLuint id = 0;
+        GLint position = -1;
+        GLint color = -1;
+        GLint draw = -1;
+        GLuint viewBlock = GL_INVALID_INDEX;
+    };
+
+    /**
+     * Typed interface of the instanced star program.
+     */
+    struct StarProgram {
+        GLuint id = 0;
+        GLint position = -1;
+        GLint transform = -1;
+        GLint style = -1;
+        GLint draw = -1;
+        GLuint styleBlock = GL_INVALID_INDEX;
+        GLuint viewBlock = GL_INVALID_INDEX;
+    };
+
+    /**
+     * Typed interface of the cached layer composite program.
+     */
+    struct LayerProgram {
+        GLuint id = 0;
+        GLint position = -1;
+        GLint draw = -1;
+        GLint texture = -1;
+    };
+
+    /**
+     * Programs and constant meshes, created in the EGLDevice share group by the first
+     * surface and used by every surface and context after it; the last core to be released
+     * deletes them. Render thread only.
+     */
+    struct SharedResources {
+        ColorProgram colorProgram;
+        StarProgram starProgram;
+        LayerProgram layerProgram;
+        GLuint starMeshVbo = 0;
+        GLuint starIndexBuffer = 0;
+        GLuint layerQuadVbo = 0;
+        uint32_t users = 0;
+        bool ready = false;
+    };
+
+    static SharedResources shared_;
 
 private:
     EGLNativeWindowType eglWindow_;
-    EGLDisplay eglDisplay_ = EGL_NO_DISPLAY;
-    EGLConfig eglConfig_ = EGL_NO_CONFIG_KHR;
     EGLSurface eglSurface_ = EGL_NO_SURFACE;
-    EGLContext eglContext_ = EGL_NO_CONTEXT;
-    GLuint program_;
+    RenderContext* context_ = nullptr;
+    // State cache of the shared context.
+    GLStateCache* stateCache_ = nullptr;
+    RingBuffer ringBuffer_;
+    GeometryBatcher batcher_;
+    DrawList drawList_;
+    // Draws rendered into a cached layer, submitted while its framebuffer is bound.
+    DrawList layerList_;
+    LayerCache layerCache_;
+    ColorProgram colorProgram_;
+    StarProgram starProgram_;
+    LayerProgram layerProgram_;
     bool flag_ = false;
-    int width_;
-    int height_;
-    GLfloat widthPercent_;
+    // Draw() and ChangeColor() requests not yet on screen because their frame was deferred.
+    bool drawDeferred_ = false;
+    bool changeColorDeferred_ = false;
+    bool frameBlocked_ = false;
+    int width_ = 0;
+    int height_ = 0;
+    GLfloat projection_[16];
+    GLfloat view_[16];
+    GLfloat viewProjection_[16];
+    GLuint viewUbo_ = 0;
+    bool viewDirty_ = true;
+    GLuint starVao_ = 0;
+    GLuint starMeshVbo_ = 0;
+    GLuint starIndexBuffer_ = 0;
+    GLuint starInstanceVbo_ = 0;
+    size_t starInstanceCapacity_ = 0;
+    SceneGraph scene_;
+    SceneNodeId patternNode_ = SceneGraph::INVALID_NODE;
+    SceneNodeId defaultStarNode_ = SceneGraph::INVALID_NODE;
+    std::vector<SceneNodeId> customStarNodes_;
+    uint32_t instanceDirtyBegin_ = UINT32_MAX;
+    uint32_t instanceDirtyEnd_ = 0;
+    // Recorded star pass, replayed every frame until invalidated.
+    CommandList starBundle_;
+    bool starLayerCached_ = false;
+    DamageTracker damage_;
+    // Window-space area of the stars and streamed shapes as last presented.
+    DamageRect starBounds_ = {};
+    DamageRect shapeBounds_ = {};
+    bool starsDrawn_ = false;
+    bool starsPresented_ = false;
+    bool bufferAgeSupported_ = false;
+    bool partialUpdateSupported_ = false;
+    bool swapWithDamageSupported_ = false;
+    uint64_t skippedFrames_ = 0;
+    GLuint layerVao_ = 0;
+    GLuint layerQuadVbo_ = 0;
+    GLuint styleUbo_ = 0;
+    DrawStyle styles_[MAX_STYLES];
+    uint32_t styleDirtyBegin_ = MAX_STYLES;
+    uint32_t styleDirtyEnd_ = 0;
+    bool geometryReady_ = false;
+    // Counted in shared_.users until released.
+    bool sharedAcquired_ = false;
+    GLsync frameFences_[MAX_FRAMES_IN_FLIGHT] = {};
+    int framesInFlight_ = 2;
+    uint32_t frameIndex_ = 0;
 };
 } // namespace NativeXComponentSample
 #endif // NATIVE_XCOMPONENT_EGL_CORE_H
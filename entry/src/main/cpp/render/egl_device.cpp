@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "egl_device.h"
+
+#include <cstdlib>
+#include <hilog/log.h>
+
+#include "../common/common.h"
+
+namespace NativeXComponentSample {
+namespace {
+/**
+ * Egl red size default.
+ */
+const int EGL_RED_SIZE_DEFAULT = 8;
+
+/**
+ * Egl green size default.
+ */
+const int EGL_GREEN_SIZE_DEFAULT = 8;
+
+/**
+ * Egl blue size default.
+ */
+const int EGL_BLUE_SIZE_DEFAULT = 8;
+
+/**
+ * Egl alpha size default.
+ */
+const int EGL_ALPHA_SIZE_DEFAULT = 8;
+
+/**
+ * Egl depth size default; the batcher spaces vertex depths for a 24-bit buffer.
+ */
+const int EGL_DEPTH_SIZE_DEFAULT = 24;
+
+/**
+ * Config attribute list.
+ */
+const EGLint ATTRIB_LIST[] = {
+    // Key,value.
+    EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+    EGL_RED_SIZE, EGL_RED_SIZE_DEFAULT,
+    EGL_GREEN_SIZE, EGL_GREEN_SIZE_DEFAULT,
+    EGL_BLUE_SIZE, EGL_BLUE_SIZE_DEFAULT,
+    EGL_ALPHA_SIZE, EGL_ALPHA_SIZE_DEFAULT,
+    EGL_DEPTH_SIZE, EGL_DEPTH_SIZE_DEFAULT,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT_KHR,
+    // End.
+    EGL_NONE};
+
+/**
+ * Context attributes.
+ */
+const EGLint CONTEXT_ATTRIBS[] = {
+    EGL_CONTEXT_CLIENT_VERSION, 3,
+    EGL_NONE};
+} // namespace
+
+EGLDevice& EGLDevice::Instance()
+{
+    static EGLDevice device;
+    return device;
+}
+
+bool EGLDevice::Init()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shareRoot_ != EGL_NO_CONTEXT) {
+        return true;
+    }
+    // setup mesa for our needs
+    setenv("MESA_LOADER_DRIVER_OVERRIDE", "zink", 1);
+    setenv("EGL_LOG_LEVEL", "debug", 1);
+    setenv("MESA_LOG", "ohos", 1);
+    setenv("MESA_GLES_VERSION_OVERRIDE", "3.1", 1);
+    setenv("ZINK_DEBUG", "spirv,nir", 1);
+
+    // Init display.
+    display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display_ == EGL_NO_DISPLAY) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLDevice", "eglGetDisplay: unable to get EGL display");
+        return false;
+    }
+
+    EGLint majorVersion;
+    EGLint minorVersion;
+    if (!eglInitialize(display_, &majorVersion, &minorVersion)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLDevice",
+                     "eglInitialize: unable to get initialize EGL display");
+        display_ = EGL_NO_DISPLAY;
+        return false;
+    }
+    OH_LOG_Print(LOG_APP, LOG_INFO, LOG_PRINT_DOMAIN, "EGLDevice", "egl vendor %{public}s",
+                 eglQueryString(display_, EGL_VENDOR));
+
+    // Select configuration.
+    const EGLint maxConfigSize = 1;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display_, ATTRIB_LIST, &config_, maxConfigSize, &numConfigs) || (numConfigs == 0)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLDevice", "eglChooseConfig: unable to choose configs");
+        return false;
+    }
+
+    // Root of the share group; later contexts come and go, the shared objects stay.
+    shareRoot_ = eglCreateContext(display_, config_, EGL_NO_CONTEXT, CONTEXT_ATTRIBS);
+    if (shareRoot_ == EGL_NO_CONTEXT) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLDevice", "eglCreateContext: share root failed");
+        return false;
+    }
+    return true;
+}
+
+void EGLDevice::Shutdown()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (display_ == EGL_NO_DISPLAY) {
+        return;
+    }
+    if ((shareRoot_ != EGL_NO_CONTEXT) && !eglDestroyContext(display_, shareRoot_)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLDevice", "eglDestroyContext: share root failed");
+    }
+    shareRoot_ = EGL_NO_CONTEXT;
+    if (!eglTerminate(display_)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLDevice", "eglTerminate failed");
+    }
+    display_ = EGL_NO_DISPLAY;
+    config_ = EGL_NO_CONFIG_KHR;
+}
+
+EGLContext EGLDevice::CreateContext()
+{
+    if (!Init()) {
+        return EGL_NO_CONTEXT;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    EGLContext context = eglCreateContext(display_, config_, shareRoot_, CONTEXT_ATTRIBS);
+    if (context == EGL_NO_CONTEXT) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLDevice", "eglCreateContext failed");
+    }
+    return context;
+}
+
+void EGLDevice::DestroyContext(EGLContext context)
+{
+    if ((context == EGL_NO_CONTEXT) || (display_ == EGL_NO_DISPLAY)) {
+        return;
+    }
+    if (!eglDestroyContext(display_, context)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLDevice", "eglDestroyContext failed");
+    }
+}
+
+EGLSurface EGLDevice::CreateWindowSurface(void* window)
+{
+    if ((window == nullptr) || !Init()) {
+        return EGL_NO_SURFACE;
+    }
+    EGLSurface surface =
+        eglCreateWindowSurface(display_, config_, static_cast<EGLNativeWindowType>(window), nullptr);
+    if (surface == EGL_NO_SURFACE) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLDevice",
+                     "eglCreateWindowSurface: unable to create surface");
+    }
+    return surface;
+}
+
+bool EGLDevice::DestroySurface(EGLSurface surface)
+{
+    if ((surface == EGL_NO_SURFACE) || (display_ == EGL_NO_DISPLAY)) {
+        return false;
+    }
+    if (!eglDestroySurface(display_, surface)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "EGLDevice", "eglDestroySurface failed");
+        return false;
+    }
+    return true;
+}
+
+bool EGLDevice::HasExtension(const char* name) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (display_ != EGL_NO_DISPLAY) && epoxy_has_egl_extension(display_, name);
+}
+} // namespace NativeXComponentSample
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_EGL_DEVICE_H
+#define NATIVE_XCOMPONENT_EGL_DEVICE_H
+
+#include <epoxy/egl.h>
+#include <mutex>
+
+namespace NativeXComponentSample {
+/**
+ * Process-wide EGL display and config, initialized by the first caller and kept until
+ * Shutdown(). Every context it hands out shares objects with a root context that is never
+ * made current, so programs, buffers and textures created in any of them survive the
+ * others being destroyed and recreated. Thread-safe.
+ */
+class EGLDevice {
+public:
+    static EGLDevice& Instance();
+
+    bool Init();
+    // Destroys the share root and terminates the display, freeing whatever contexts and
+    // surfaces are still alive; the next Init() starts over.
+    void Shutdown();
+    // New context in the device's share group, or EGL_NO_CONTEXT.
+    EGLContext CreateContext();
+    void DestroyContext(EGLContext context);
+    EGLSurface CreateWindowSurface(void* window);
+    bool DestroySurface(EGLSurface surface);
+    bool HasExtension(const char* name) const;
+    EGLDisplay Display() const
+    {
+        return display_;
+    }
+
+private:
+    EGLDevice() = default;
+    EGLDevice(const EGLDevice&) = delete;
+    EGLDevice& operator=(const EGLDevice&) = delete;
+
+    mutable std::mutex mutex_;
+    EGLDisplay display_ = EGL_NO_DISPLAY;
+    EGLConfig config_ = EGL_NO_CONFIG_KHR;
+    // Owns the share group; only ever used as share_context.
+    EGLContext shareRoot_ = EGL_NO_CONTEXT;
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_EGL_DEVICE_H
@@ -0,0 +1,563 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "geometry_batcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <hilog/log.h>
+
+#include "../common/common.h"
+
+namespace NativeXComponentSample {
+namespace {
+/**
+ * Position components per vertex.
+ */
+const GLint POSITION_SIZE = 2;
+
+/**
+ * Color components per vertex.
+ */
+const GLint COLOR_SIZE = 4;
+
+/**
+ * Vertices reserved up front so typical frames never reallocate.
+ */
+const size_t INITIAL_VERTEX_RESERVE = 1024;
+
+/**
+ * Indices reserved up front per primitive stream.
+ */
+const size_t INITIAL_INDEX_RESERVE = 2048;
+
+/**
+ * Vertices of a triangle.
+ */
+const size_t TRIANGLE_VERTEX_COUNT = 3;
+
+/**
+ * Corners of a quad.
+ */
+const size_t QUAD_CORNER_COUNT = 4;
+
+/**
+ * Largest magnitude of a normalized 16-bit component.
+ */
+const GLfloat NORM_INT16_MAX = 32767.0f;
+
+/**
+ * Largest value of a normalized 8-bit color component.
+ */
+const GLfloat NORM_UINT8_MAX = 255.0f;
+
+/**
+ * Vertex size of the compact formats: two 16-bit position components and RGBA8.
+ */
+const GLsizei COMPACT_VERTEX_SIZE = 8;
+
+/**
+ * Byte offset of the color inside a compact vertex.
+ */
+const size_t COMPACT_COLOR_OFFSET = 4;
+
+/**
+ * Vertices one frame can order by depth. Beyond it z would leave [-1, 0) and shapes
+ * would be clipped, so further shapes are rejected until EndFrame().
+ */
+const size_t MAX_FRAME_VERTICES = (1 << 20) - 1;
+
+/**
+ * Depth distance between consecutive vertices of a frame; MAX_FRAME_VERTICES fit in
+ * [-1, 0) with several 24-bit depth steps between neighbours.
+ */
+const GLfloat DEPTH_STEP = 1.0f / (MAX_FRAME_VERTICES + 1);
+
+int16_t FloatToNormShort(GLfloat value)
+{
+    GLfloat clamped = std::min(1.0f, std::max(-1.0f, value));
+    return static_cast<int16_t>(clamped * NORM_INT16_MAX + (clamped >= 0 ? 0.5f : -0.5f));
+}
+
+uint8_t FloatToNormByte(GLfloat value)
+{
+    GLfloat clamped = std::min(1.0f, std::max(0.0f, value));
+    return static_cast<uint8_t>(clamped * NORM_UINT8_MAX + 0.5f);
+}
+} // namespace
+
+uint16_t FloatToHalf(GLfloat value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t biased = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+    if ((biased == 0xFF) && (mantissa != 0)) {
+        // Quiet NaN; truncating the payload could otherwise leave an infinity.
+        return static_cast<uint16_t>(sign | 0x7E00);
+    }
+    int32_t exponent = static_cast<int32_t>(biased) - 127 + 15;
+    if (exponent <= 0) {
+        // Below the half normal range; pixel coordinates this small round to zero.
+        return static_cast<uint16_t>(sign);
+    }
+    if (exponent >= 0x1F) {
+        // Infinities, and finite values past the half range.
+        return static_cast<uint16_t>(sign | 0x7C00);
+    }
+    // Round to nearest; a mantissa carry correctly bumps the exponent, up to infinity.
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    return static_cast<uint16_t>(half + ((mantissa >> 12) & 1));
+}
+
+bool GeometryBatcher::Init(GLStateCache* stateCache, RingBuffer* ringBuffer, DrawList* drawList,
+                           const BatchProgram& program, uint8_t layer)
+{
+    if ((stateCache == nullptr) || (ringBuffer == nullptr) || (ringBuffer->Buffer() == 0) || (drawList == nullptr) ||
+        (program.id == 0) || (program.position < 0) || (program.color < 0) || (program.draw < 0)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GeometryBatcher", "Init: param error");
+        return false;
+    }
+    stateCache_ = stateCache;
+    ringBuffer_ = ringBuffer;
+    drawList_ = drawList;
+    program_ = program;
+    layer_ = layer;
+
+    // One vertex array per format, so draws recorded before a format switch keep their layout.
+    glGenVertexArrays(VERTEX_FORMAT_COUNT, vaos_);
+    for (size_t i = 0; i < VERTEX_FORMAT_COUNT; ++i) {
+        if (vaos_[i] == 0) {
+            OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GeometryBatcher", "Init: unable to create vao");
+            return false;
+        }
+        SetupAttributes(static_cast<VertexFormat>(i));
+    }
+    vao_ = vaos_[static_cast<size_t>(format_)];
+
+    vertices_.reserve(INITIAL_VERTEX_RESERVE);
+    for (Pass* pass : { &opaque_, &translucent_ }) {
+        pass->triangles.indices.reserve(INITIAL_INDEX_RESERVE);
+        pass->fans.indices.reserve(INITIAL_INDEX_RESERVE);
+        pass->strips.indices.reserve(INITIAL_INDEX_RESERVE);
+    }
+    uploaded_ = false;
+    frameVertices_ = 0;
+    stats_ = {};
+    return true;
+}
+
+void GeometryBatcher::SetupAttributes(VertexFormat format)
+{
+    // Attributes point at the start of the ring; each flush rebases its indices instead of
+    // re-pointing attributes. Indices come from the same ring.
+    stateCache_->BindVertexArray(vaos_[static_cast<size_t>(format)]);
+    stateCache_->BindBuffer(GL_ARRAY_BUFFER, ringBuffer_->Buffer());
+    GLsizei stride = Stride(format);
+    switch (format) {
+        case VertexFormat::HALF_FLOAT:
+            glVertexAttribPointer(program_.position, POSITION_SIZE, GL_HALF_FLOAT, GL_FALSE, stride, nullptr);
+            break;
+        case VertexFormat::NORM_INT16:
+            glVertexAttribPointer(program_.position, POSITION_SIZE, GL_SHORT, GL_TRUE, stride, nullptr);
+            break;
+        case VertexFormat::FLOAT32:
+        default:
+            glVertexAttribPointer(program_.position, POSITION_SIZE, GL_FLOAT, GL_FALSE, stride,
+                                  reinterpret_cast<const void*>(offsetof(BatchVertex, x)));
+            break;
+    }
+    stateCache_->EnableVertexAttribArray(program_.position);
+    if (format == VertexFormat::FLOAT32) {
+        glVertexAttribPointer(program_.color, COLOR_SIZE, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<const void*>(offsetof(BatchVertex, color)));
+    } else {
+        glVertexAttribPointer(program_.color, COLOR_SIZE, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                              reinterpret_cast<const void*>(COMPACT_COLOR_OFFSET));
+    }
+    stateCache_->EnableVertexAttribArray(program_.color);
+    stateCache_->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ringBuffer_->Buffer());
+    stateCache_->BindVertexArray(0);
+}
+
+bool GeometryBatcher::SetVertexFormat(VertexFormat format, GLfloat extent)
+{
+    if (extent <= 0) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GeometryBatcher", "SetVertexFormat: param error");
+        return false;
+    }
+    if ((format == format_) && (extent == extent_)) {
+        return true;
+    }
+    // Pending shapes were packed for the old layout; record them first.
+    Flush();
+    format_ = format;
+    extent_ = extent;
+    if (vao_ != 0) {
+        vao_ = vaos_[static_cast<size_t>(format_)];
+    }
+    return true;
+}
+
+GLsizei GeometryBatcher::Stride(VertexFormat format)
+{
+    return (format == VertexFormat::FLOAT32) ? static_cast<GLsizei>(sizeof(BatchVertex)) : COMPACT_VERTEX_SIZE;
+}
+
+void GeometryBatcher::PackVertices(void* out) const
+{
+    if (format_ == VertexFormat::FLOAT32) {
+        memcpy(out, vertices_.data(), vertices_.size() * sizeof(BatchVertex));
+        return;
+    }
+    uint8_t* dst = static_cast<uint8_t*>(out);
+    GLfloat invExtent = 1.0f / extent_;
+    for (const BatchVertex& vertex : vertices_) {
+        if (format_ == VertexFormat::HALF_FLOAT) {
+            uint16_t position[POSITION_SIZE] = { FloatToHalf(vertex.x), FloatToHalf(vertex.y) };
+            memcpy(dst, position, sizeof(position));
+        } else {
+            int16_t position[POSITION_SIZE] = { FloatToNormShort(vertex.x * invExtent),
+                FloatToNormShort(vertex.y * invExtent) };
+            memcpy(dst, position, sizeof(position));
+        }
+        uint8_t color[COLOR_SIZE] = { FloatToNormByte(vertex.color[0]), FloatToNormByte(vertex.color[1]),
+            FloatToNormByte(vertex.color[2]), FloatToNormByte(vertex.color[3]) };
+        memcpy(dst + COMPACT_COLOR_OFFSET, color, sizeof(color));
+        dst += COMPACT_VERTEX_SIZE;
+    }
+}
+
+void GeometryBatcher::Discard()
+{
+    vertices_.clear();
+    for (Pass* pass : { &opaque_, &translucent_ }) {
+        pass->triangles.indices.clear();
+        pass->fans.indices.clear();
+        pass->strips.indices.clear();
+    }
+    uploaded_ = false;
+}
+
+void GeometryBatcher::Destroy()
+{
+    if (stateCache_ != nullptr) {
+        for (GLuint vao : vaos_) {
+            stateCache_->OnVertexArrayDeleted(vao);
+        }
+    }
+    glDeleteVertexArrays(VERTEX_FORMAT_COUNT, vaos_);
+    for (GLuint& vao : vaos_) {
+        vao = 0;
+    }
+    vao_ = 0;
+    ringBuffer_ = nullptr;
+    drawList_ = nullptr;
+    Discard();
+}
+
+bool GeometryBatcher::Reserve(size_t vertexCount)
+{
+    if (vertexCount > MAX_BATCH_VERTICES) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GeometryBatcher", "shape exceeds batch capacity");
+        return false;
+    }
+    if (frameVertices_ + vertices_.size() + vertexCount > MAX_FRAME_VERTICES) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GeometryBatcher", "frame depth range exhausted");
+        return false;
+    }
+    if (vertices_.size() + vertexCount > MAX_BATCH_VERTICES) {
+        Flush();
+    }
+    ++stats_.shapes;
+    return true;
+}
+
+GLuint GeometryBatcher::Push(GLfloat x, GLfloat y, const GLfloat color[4])
+{
+    BatchVertex vertex = {x, y, {color[0], color[1], color[2], color[3]}};
+    vertices_.push_back(vertex);
+    if (!hasFrameBounds_) {
+        frameBounds_[0] = x;
+        frameBounds_[1] = y;
+        frameBounds_[2] = x;
+        frameBounds_[3] = y;
+        hasFrameBounds_ = true;
+    } else {
+        frameBounds_[0] = std::min(frameBounds_[0], x);
+        frameBounds_[1] = std::min(frameBounds_[1], y);
+        frameBounds_[2] = std::max(frameBounds_[2], x);
+        frameBounds_[3] = std::max(frameBounds_[3], y);
+    }
+    return static_cast<GLuint>(vertices_.size() - 1);
+}
+
+void GeometryBatcher::AppendRestartable(IndexStream& stream, GLuint first, size_t count)
+{
+    // One restart index separates consecutive fans or strips in the same draw.
+    if (!stream.indices.empty()) {
+        stream.indices.push_back(RESTART_INDEX);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        stream.indices.push_back(first + static_cast<GLuint>(i));
+    }
+}
+
+bool GeometryBatcher::AddTriangle(const GLfloat vertices[6], const GLfloat color[4])
+{
+    if ((vertices == nullptr) || (color == nullptr) || !Reserve(TRIANGLE_VERTEX_COUNT)) {
+        return false;
+    }
+    Pass& pass = PassFor(color);
+    for (size_t i = 0; i < TRIANGLE_VERTEX_COUNT; ++i) {
+        pass.triangles.indices.push_back(Push(vertices[i * POSITION_SIZE], vertices[i * POSITION_SIZE + 1], color));
+    }
+    return true;
+}
+
+bool GeometryBatcher::AddQuad(const GLfloat vertices[8], const GLfloat color[4])
+{
+    return AddFan(vertices, QUAD_CORNER_COUNT, color);
+}
+
+bool GeometryBatcher::AddFan(const GLfloat* vertices, size_t vertexCount, const GLfloat color[4])
+{
+    if ((vertices == nullptr) || (color == nullptr) || (vertexCount < TRIANGLE_VERTEX_COUNT)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GeometryBatcher", "AddFan: param error");
+        return false;
+    }
+    if (!Reserve(vertexCount)) {
+        return false;
+    }
+    GLuint first = static_cast<GLuint>(vertices_.size());
+    for (size_t i = 0; i < vertexCount; ++i) {
+        Push(vertices[i * POSITION_SIZE], vertices[i * POSITION_SIZE + 1], color);
+    }
+    AppendRestartable(PassFor(color).fans, first, vertexCount);
+    return true;
+}
+
+bool GeometryBatcher::AddStrip(const GLfloat* vertices, size_t vertexCount, const GLfloat color[4])
+{
+    if ((vertices == nullptr) || (color == nullptr) || (vertexCount < TRIANGLE_VERTEX_COUNT)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GeometryBatcher", "AddStrip: param error");
+        return false;
+    }
+    if (!Reserve(vertexCount)) {
+        return false;
+    }
+    GLuint first = static_cast<GLuint>(vertices_.size());
+    for (size_t i = 0; i < vertexCount; ++i) {
+        Push(vertices[i * POSITION_SIZE], vertices[i * POSITION_SIZE + 1], color);
+    }
+    AppendRestartable(PassFor(color).strips, first, vertexCount);
+    return true;
+}
+
+bool GeometryBatcher::AddMesh(const ShapeMesh& mesh, GLfloat centerX, GLfloat centerY, GLfloat radius,
+                              const GLfloat color[4])
+{
+    if ((mesh.vertices == nullptr) || (mesh.indices == nullptr) || (color == nullptr) ||
+        (mesh.vertexCount <= 0) || (mesh.indexCount < static_cast<GLsizei>(TRIANGLE_VERTEX_COUNT)) ||
+        (mesh.indexCount % static_cast<GLsizei>(TRIANGLE_VERTEX_COUNT) != 0)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GeometryBatcher", "AddMesh: param error");
+        return false;
+    }
+    // A stray index would draw from another shape's vertices; partial triangles break reversed copies.
+    for (GLsizei i = 0; i < mesh.indexCount; ++i) {
+        if (mesh.indices[i] >= mesh.vertexCount) {
+            OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GeometryBatcher",
+                         "AddMesh: index %{public}d out of range", mesh.indices[i]);
+            return false;
+        }
+    }
+    if (!Reserve(static_cast<size_t>(mesh.vertexCount))) {
+        return false;
+    }
+    // Shared corners stay shared; only the indices are rebased.
+    GLuint first = static_cast<GLuint>(vertices_.size());
+    for (GLsizei i = 0; i < mesh.vertexCount; ++i) {
+        Push(centerX + radius * mesh.vertices[i * POSITION_SIZE],
+             centerY + radius * mesh.vertices[i * POSITION_SIZE + 1], color);
+    }
+    Pass& pass = PassFor(color);
+    for (GLsizei i = 0; i < mesh.indexCount; ++i) {
+        pass.triangles.indices.push_back(first + mesh.indices[i]);
+    }
+    return true;
+}
+
+void GeometryBatcher::CopyIndices(const IndexStream& stream, bool reverse, GLuint* out) const
+{
+    // Rebase while copying; GLES 3.0 has no base-vertex draws.
+    const std::vector<GLuint>& indices = stream.indices;
+    if (!reverse) {
+        for (GLuint index : indices) {
+            *out++ = (index == RESTART_INDEX) ? RESTART_INDEX : index + baseVertex_;
+        }
+        return;
+    }
+    // Emit whole primitives (triangles, or restart-separated fans and strips) newest first.
+    size_t end = indices.size();
+    while (end > 0) {
+        size_t begin = end;
+        if (stream.mode == GL_TRIANGLES) {
+            // Producers only append whole triangles; clamp anyway so a short tail cannot wrap.
+            begin = (end >= TRIANGLE_VERTEX_COUNT) ? end - TRIANGLE_VERTEX_COUNT : 0;
+        } else {
+            while ((begin > 0) && (indices[begin - 1] != RESTART_INDEX)) {
+                --begin;
+            }
+        }
+        for (size_t i = begin; i < end; ++i) {
+            *out++ = indices[i] + baseVertex_;
+        }
+        if (begin > 0 && (stream.mode != GL_TRIANGLES)) {
+            *out++ = RESTART_INDEX;
+            --begin;
+        }
+        end = begin;
+    }
+}
+
+bool GeometryBatcher::Record(IndexStream& stream, bool opaque)
+{
+    if (stream.indices.empty()) {
+        return false;
+    }
+    GLsizeiptr size = static_cast<GLsizeiptr>(stream.indices.size() * sizeof(GLuint));
+    RingAllocation allocation;
+    if (!ringBuffer_->Map(size, sizeof(GLuint), allocation)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GeometryBatcher", "Record: map failed");
+        stream.indices.clear();
+        return false;
+    }
+    CopyIndices(stream, opaque, static_cast<GLuint*>(allocation.data));
+    if (!ringBuffer_->Unmap()) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GeometryBatcher", "Record: unmap failed");
+        stream.indices.clear();
+        return false;
+    }
+
+    // Opaque batches sort by their nearest vertex, translucent ones by their farthest.
+    GLfloat nearest = -(static_cast<GLfloat>(frameVertices_ + vertices_.size())) * DEPTH_STEP;
+    GLfloat farthest = -(static_cast<GLfloat>(frameVertices_) + 1.0f) * DEPTH_STEP;
+    DrawCommand command = {};
+    command.program = program_.id;
+    command.vertexArray = vao_;
+    command.mode = stream.mode;
+    command.count = static_cast<GLsizei>(stream.indices.size());
+    command.indexType = GL_UNSIGNED_INT;
+    command.indexOffset = allocation.offset;
+    command.instances = 1;
+    command.blend = !opaque;
+    command.drawUniform = program_.draw;
+    memcpy(command.drawParams, drawParams_, sizeof(command.drawParams));
+    drawList_->Add(DrawList::MakeKey(layer_, program_.id, 0, !opaque, opaque ? nearest : farthest), command);
+
+    stats_.indices += static_cast<uint32_t>(stream.indices.size());
+    stats_.bytes += static_cast<uint64_t>(size);
+    stream.indices.clear();
+    return true;
+}
+
+bool GeometryBatcher::Upload()
+{
+    if (uploaded_) {
+        return true;
+    }
+    // Vertex-aligned region so indices can be rebased by a whole number of vertices.
+    GLsizei stride = Stride(format_);
+    GLsizeiptr size = static_cast<GLsizeiptr>(vertices_.size()) * stride;
+    RingAllocation allocation;
+    if (!ringBuffer_->Map(size, stride, allocation)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GeometryBatcher", "Upload: map failed");
+        Discard();
+        return false;
+    }
+    PackVertices(allocation.data);
+    if (!ringBuffer_->Unmap()) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "GeometryBatcher", "Upload: unmap failed");
+        Discard();
+        return false;
+    }
+    baseVertex_ = static_cast<GLuint>(allocation.offset / stride);
+    stats_.bytes += static_cast<uint64_t>(size);
+    uploaded_ = true;
+
+    // z = -(frame sequence + 1) * DEPTH_STEP, expressed in terms of gl_VertexID.
+    // Normalized positions are scaled back to pixels on the GPU.
+    drawParams_[0] = -(static_cast<GLfloat>(frameVertices_) + 1.0f - static_cast<GLfloat>(baseVertex_)) *
+        DEPTH_STEP;
+    drawParams_[1] = DEPTH_STEP;
+    drawParams_[2] = (format_ == VertexFormat::NORM_INT16) ? extent_ : 1.0f;
+    drawParams_[3] = 0;
+    return true;
+}
+
+uint32_t GeometryBatcher::RecordPass(Pass& pass, bool opaque)
+{
+    if (pass.triangles.indices.empty() && pass.fans.indices.empty() && pass.strips.indices.empty()) {
+        return 0;
+    }
+    if (!Upload()) {
+        return 0;
+    }
+    uint32_t drawCalls = 0;
+    drawCalls += Record(pass.triangles, opaque) ? 1 : 0;
+    drawCalls += Record(pass.fans, opaque) ? 1 : 0;
+    drawCalls += Record(pass.strips, opaque) ? 1 : 0;
+    stats_.drawCalls += drawCalls;
+    return drawCalls;
+}
+
+uint32_t GeometryBatcher::Flush()
+{
+    if (vertices_.empty() || (vao_ == 0)) {
+        return 0;
+    }
+    uint32_t drawCalls = RecordPass(opaque_, true);
+    drawCalls += RecordPass(translucent_, false);
+
+    stats_.vertices += static_cast<uint32_t>(vertices_.size());
+    frameVertices_ += static_cast<uint32_t>(vertices_.size());
+    vertices_.clear();
+    uploaded_ = false;
+    return drawCalls;
+}
+
+void GeometryBatcher::EndFrame()
+{
+    frameVertices_ = 0;
+    hasFrameBounds_ = false;
+}
+
+bool GeometryBatcher::FrameBounds(GLfloat bounds[4]) const
+{
+    if (!hasFrameBounds_) {
+        return false;
+    }
+    memcpy(bounds, frameBounds_, sizeof(frameBounds_));
+    return true;
+}
+
+BatchStats GeometryBatcher::TakeStats()
+{
+    BatchStats stats = stats_;
+    stats_ = {};
+    return stats;
+}
+} // namespace NativeXComponentSample
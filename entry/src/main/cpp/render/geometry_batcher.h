@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_GEOMETRY_BATCHER_H
+#define NATIVE_XCOMPONENT_GEOMETRY_BATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <epoxy/gl.h>
+#include <vector>
+#include "render/draw_list.h"
+#include "render/gl_state_cache.h"
+#include "render/ring_buffer.h"
+#include "render/shape_library.h"
+
+namespace NativeXComponentSample {
+/**
+ * Interleaved vertex of the batched color stream.
+ */
+struct BatchVertex {
+    GLfloat x;
+    GLfloat y;
+    GLfloat color[4];
+};
+
+/**
+ * GPU-side layout of batched vertices. Shapes are always queued as BatchVertex and
+ * packed into the selected layout while being written to the ring.
+ * FLOAT32:    float x/y + float RGBA, 24 bytes.
+ * HALF_FLOAT: half x/y + normalized RGBA8, 8 bytes.
+ * NORM_INT16: normalized short x/y (scaled by the format extent) + normalized RGBA8, 8 bytes.
+ */
+enum class VertexFormat : uint8_t {
+    FLOAT32,
+    HALF_FLOAT,
+    NORM_INT16,
+};
+
+/**
+ * Number of VertexFormat values.
+ */
+constexpr size_t VERTEX_FORMAT_COUNT = 3;
+
+/**
+ * Half-precision bits of value, rounded to nearest. NaN stays NaN, and infinities and
+ * values past the half range become infinities; values below the normal range flush to zero.
+ */
+uint16_t FloatToHalf(GLfloat value);
+
+/**
+ * Per-flush counters, reset by TakeStats(). bytes counts vertex and index data written
+ * to the ring, for comparing vertex formats.
+ */
+struct BatchStats {
+    uint32_t shapes;
+    uint32_t vertices;
+    uint32_t indices;
+    uint32_t drawCalls;
+    uint64_t bytes;
+};
+
+/**
+ * Locations of the flat color program the batcher draws with. draw is the per-draw
+ * vec4 (depth base, depth step, position scale, unused); each vertex gets
+ * z = base - gl_VertexID * step.
+ */
+struct BatchProgram {
+    GLuint id;
+    GLint position;
+    GLint color;
+    GLint draw;
+};
+
+/**
+ * Accumulates arbitrary colored triangles, quads, fans, strips and library meshes into one
+ * shared vertex stream. Shapes are indexed, so shared corners are stored once; fans and
+ * strips are separated by the fixed primitive restart index, so a flush records at most one
+ * indexed draw per primitive type and pass into the frame's DrawList. Vertices and indices
+ * are streamed through the shared RingBuffer.
+ *
+ * Every vertex gets a depth in [-1, 0) that decreases in submission order, so later shapes
+ * win the depth test. Opaque shapes (alpha 1) are recorded with their primitives reversed
+ * (front to back) and without blending; translucent shapes keep painter's order and blend.
+ * The DrawList orders both passes against other layers; the depth test itself is enabled
+ * by the owner. Positions are in pixels relative to the surface center,
+ * y up; the program's view-projection maps them to clip space on the GPU. Must be used
+ * on the thread that owns the GL context.
+ */
+class GeometryBatcher {
+public:
+    bool Init(GLStateCache* stateCache, RingBuffer* ringBuffer, DrawList* drawList, const BatchProgram& program,
+              uint8_t layer);
+    void Destroy();
+    bool AddTriangle(const GLfloat vertices[6], const GLfloat color[4]);
+    bool AddQuad(const GLfloat vertices[8], const GLfloat color[4]);
+    bool AddFan(const GLfloat* vertices, size_t vertexCount, const GLfloat color[4]);
+    bool AddStrip(const GLfloat* vertices, size_t vertexCount, const GLfloat color[4]);
+    // Places a unit shape from the shape library at (centerX, centerY) scaled by radius.
+    bool AddMesh(const ShapeMesh& mesh, GLfloat centerX, GLfloat centerY, GLfloat radius, const GLfloat color[4]);
+    // extent is the pixel range mapped to [-1, 1] by NORM_INT16; ignored by other formats.
+    bool SetVertexFormat(VertexFormat format, GLfloat extent = DEFAULT_NORM_EXTENT);
+    VertexFormat Format() const
+    {
+        return format_;
+    }
+    GLfloat Extent() const
+    {
+        return extent_;
+    }
+    uint32_t Flush();
+    // Restarts the per-frame depth sequence and bounds; call once the frame is submitted.
+    void EndFrame();
+    // Pixel-space box (minX, minY, maxX, maxY) of every vertex queued this frame; false if none.
+    bool FrameBounds(GLfloat bounds[4]) const;
+    BatchStats TakeStats();
+    bool Empty() const
+    {
+        return vertices_.empty();
+    }
+    // True while nothing was queued since the last EndFrame(), flushed or not.
+    bool FrameEmpty() const
+    {
+        return !hasFrameBounds_;
+    }
+
+    static constexpr size_t MAX_BATCH_VERTICES = 65535;
+    // GL_PRIMITIVE_RESTART_FIXED_INDEX for GL_UNSIGNED_INT indices.
+    static constexpr GLuint RESTART_INDEX = 0xFFFFFFFF;
+    static constexpr GLfloat DEFAULT_NORM_EXTENT = 4096.0f;
+
+private:
+    /**
+     * Indices of one primitive type, relative to the start of the pending vertices.
+     */
+    struct IndexStream {
+        GLenum mode;
+        std::vector<GLuint> indices;
+    };
+
+    /**
+     * Shapes sharing one blend state.
+     */
+    struct Pass {
+        IndexStream triangles = { GL_TRIANGLES, {} };
+        IndexStream fans = { GL_TRIANGLE_FAN, {} };
+        IndexStream strips = { GL_TRIANGLE_STRIP, {} };
+    };
+
+    bool Reserve(size_t vertexCount);
+    GLuint Push(GLfloat x, GLfloat y, const GLfloat color[4]);
+    Pass& PassFor(const GLfloat color[4])
+    {
+        return (color[3] < 1.0f) ? translucent_ : opaque_;
+    }
+    void AppendRestartable(IndexStream& stream, GLuint first, size_t count);
+    bool Upload();
+    uint32_t RecordPass(Pass& pass, bool opaque);
+    bool Record(IndexStream& stream, bool opaque);
+    void CopyIndices(const IndexStream& stream, bool reverse, GLuint* out) const;
+    void SetupAttributes(VertexFormat format);
+    static GLsizei Stride(VertexFormat format);
+    void PackVertices(void* out) const;
+    void Discard();
+
+    GLStateCache* stateCache_ = nullptr;
+    RingBuffer* ringBuffer_ = nullptr;
+    DrawList* drawList_ = nullptr;
+    uint8_t layer_ = 0;
+    BatchProgram program_ = {};
+    VertexFormat format_ = VertexFormat::FLOAT32;
+    GLfloat extent_ = DEFAULT_NORM_EXTENT;
+    GLuint vaos_[VERTEX_FORMAT_COUNT] = {};
+    // Vertex array of the current format.
+    GLuint vao_ = 0;
+    std::vector<BatchVertex> vertices_;
+    Pass opaque_;
+    Pass translucent_;
+    bool uploaded_ = false;
+    GLuint baseVertex_ = 0;
+    GLfloat drawParams_[4] = {};
+    uint32_t frameVertices_ = 0;
+    GLfloat frameBounds_[4] = {};
+    bool hasFrameBounds_ = false;
+    BatchStats stats_ = {};
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_GEOMETRY_BATCHER_H
@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gl_state_cache.h"
+
+#include <cstring>
+
+namespace NativeXComponentSample {
+void GLStateCache::Invalidate()
+{
+    known_ = 0;
+    knownUniformBindings_ = 0;
+    vertexArrays_.clear();
+    knownAttribValues_ = 0;
+    capabilities_.clear();
+}
+
+bool GLStateCache::MakeCurrent(EGLDisplay display, EGLSurface surface, EGLContext context)
+{
+    if (Skip((display == display_) && (surface == surface_) && (context == context_))) {
+        return true;
+    }
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        return false;
+    }
+    if (context != context_) {
+        // A different context has its own GL state.
+        Invalidate();
+    }
+    display_ = display;
+    surface_ = surface;
+    context_ = context;
+    return true;
+}
+
+void GLStateCache::ReleaseCurrent()
+{
+    if (display_ != EGL_NO_DISPLAY) {
+        eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+    display_ = EGL_NO_DISPLAY;
+    surface_ = EGL_NO_SURFACE;
+    context_ = EGL_NO_CONTEXT;
+    Invalidate();
+}
+
+void GLStateCache::UseProgram(GLuint program)
+{
+    if (Skip(((known_ & KNOWN_PROGRAM) != 0) && (program_ == program))) {
+        return;
+    }
+    glUseProgram(program);
+    program_ = program;
+    known_ |= KNOWN_PROGRAM;
+}
+
+void GLStateCache::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    const GLint viewport[] = {x, y, width, height};
+    if (Skip(((known_ & KNOWN_VIEWPORT) != 0) && (memcmp(viewport_, viewport, sizeof(viewport)) == 0))) {
+        return;
+    }
+    glViewport(x, y, width, height);
+    memcpy(viewport_, viewport, sizeof(viewport));
+    known_ |= KNOWN_VIEWPORT;
+}
+
+void GLStateCache::Scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    const GLint scissor[] = {x, y, width, height};
+    if (Skip(((known_ & KNOWN_SCISSOR) != 0) && (memcmp(scissor_, scissor, sizeof(scissor)) == 0))) {
+        return;
+    }
+    glScissor(x, y, width, height);
+    memcpy(scissor_, scissor, sizeof(scissor));
+    known_ |= KNOWN_SCISSOR;
+}
+
+void GLStateCache::ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    const GLfloat color[] = {red, green, blue, alpha};
+    if (Skip(((known_ & KNOWN_CLEAR_COLOR) != 0) && (memcmp(clearColor_, color, sizeof(color)) == 0))) {
+        return;
+    }
+    glClearColor(red, green, blue, alpha);
+    memcpy(clearColor_, color, sizeof(color));
+    known_ |= KNOWN_CLEAR_COLOR;
+}
+
+void GLStateCache::BindBuffer(GLenum target, GLuint buffer)
+{
+    switch (target) {
+        case GL_ARRAY_BUFFER:
+            if (Skip(((known_ & KNOWN_ARRAY_BUFFER) != 0) && (arrayBuffer_ == buffer))) {
+                return;
+            }
+            arrayBuffer_ = buffer;
+            known_ |= KNOWN_ARRAY_BUFFER;
+            break;
+        case GL_UNIFORM_BUFFER:
+            if (Skip(((known_ & KNOWN_UNIFORM_BUFFER) != 0) && (uniformBuffer_ == buffer))) {
+                return;
+            }
+            uniformBuffer_ = buffer;
+            known_ |= KNOWN_UNIFORM_BUFFER;
+            break;
+        case GL_ELEMENT_ARRAY_BUFFER: {
+            // Element buffer binding is part of the bound vertex array object.
+            VertexArrayState& vao = vertexArrays_[vertexArray_];
+            if (Skip(((known_ & KNOWN_VERTEX_ARRAY) != 0) && vao.elementBufferKnown &&
+                     (vao.elementBuffer == buffer))) {
+                return;
+            }
+            vao.elementBuffer = buffer;
+            vao.elementBufferKnown = (known_ & KNOWN_VERTEX_ARRAY) != 0;
+            break;
+        }
+        default:
+            break;
+    }
+    glBindBuffer(target, buffer);
+}
+
+void GLStateCache::BindUniformBufferBase(GLuint index, GLuint buffer)
+{
+    uint32_t bit = (index < MAX_TRACKED_UNIFORM_BINDINGS) ? (1u << index) : 0;
+    if (Skip((bit != 0) && ((knownUniformBindings_ & bit) != 0) && (uniformBindings_[index] == buffer))) {
+        return;
+    }
+    glBindBufferBase(GL_UNIFORM_BUFFER, index, buffer);
+    if (bit != 0) {
+        uniformBindings_[index] = buffer;
+        knownUniformBindings_ |= bit;
+    }
+    // Indexed binds also replace the generic GL_UNIFORM_BUFFER binding.
+    uniformBuffer_ = buffer;
+    known_ |= KNOWN_UNIFORM_BUFFER;
+}
+
+void GLStateCache::BindVertexArray(GLuint vao)
+{
+    if (Skip(((known_ & KNOWN_VERTEX_ARRAY) != 0) && (vertexArray_ == vao))) {
+        return;
+    }
+    glBindVertexArray(vao);
+    vertexArray_ = vao;
+    known_ |= KNOWN_VERTEX_ARRAY;
+}
+
+void GLStateCache::BindFramebuffer(GLuint framebuffer)
+{
+    if (Skip(((known_ & KNOWN_FRAMEBUFFER) != 0) && (framebuffer_ == framebuffer))) {
+        return;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    framebuffer_ = framebuffer;
+    known_ |= KNOWN_FRAMEBUFFER;
+}
+
+void GLStateCache::BindTexture(GLenum target, GLuint texture)
+{
+    if (target != GL_TEXTURE_2D) {
+        glBindTexture(target, texture);
+        return;
+    }
+    if (Skip(((known_ & KNOWN_TEXTURE_2D) != 0) && (texture2d_ == texture))) {
+        return;
+    }
+    glBindTexture(target, texture);
+    texture2d_ = texture;
+    known_ |= KNOWN_TEXTURE_2D;
+}
+
+void GLStateCache::EnableVertexAttribArray(GLuint index)
+{
+    uint32_t bit = (index < MAX_TRACKED_ATTRIBS) ? (1u << index) : 0;
+    bool trusted = ((known_ & KNOWN_VERTEX_ARRAY) != 0) && (bit != 0);
+    VertexArrayState& vao = vertexArrays_[vertexArray_];
+    if (Skip(trusted && ((vao.knownAttribs & bit) != 0) && ((vao.enabledAttribs & bit) != 0))) {
+        return;
+    }
+    glEnableVertexAttribArray(index);
+    if (trusted) {
+        vao.knownAttribs |= bit;
+        vao.enabledAttribs |= bit;
+    }
+}
+
+void GLStateCache::DisableVertexAttribArray(GLuint index)
+{
+    uint32_t bit = (index < MAX_TRACKED_ATTRIBS) ? (1u << index) : 0;
+    bool trusted = ((known_ & KNOWN_VERTEX_ARRAY) != 0) && (bit != 0);
+    VertexArrayState& vao = vertexArrays_[vertexArray_];
+    if (Skip(trusted && ((vao.knownAttribs & bit) != 0) && ((vao.enabledAttribs & bit) == 0))) {
+        return;
+    }
+    glDisableVertexAttribArray(index);
+    if (trusted) {
+        vao.knownAttribs |= bit;
+        vao.enabledAttribs &= ~bit;
+    }
+}
+
+void GLStateCache::VertexAttrib4fv(GLuint index, const GLfloat* value)
+{
+    uint32_t bit = (index < MAX_TRACKED_ATTRIBS) ? (1u << index) : 0;
+    if (Skip((bit != 0) && ((knownAttribValues_ & bit) != 0) &&
+             (memcmp(attribValues_[index], value, sizeof(attribValues_[index])) == 0))) {
+        return;
+    }
+    glVertexAttrib4fv(index, value);
+    if (bit != 0) {
+        memcpy(attribValues_[index], value, sizeof(attribValues_[index]));
+        knownAttribValues_ |= bit;
+    }
+}
+
+bool GLStateCache::SetCapability(GLenum cap, bool enabled)
+{
+    auto iter = capabilities_.find(cap);
+    if (Skip((iter != capabilities_.end()) && (iter->second == enabled))) {
+        return false;
+    }
+    capabilities_[cap] = enabled;
+    return true;
+}
+
+void GLStateCache::Enable(GLenum cap)
+{
+    if (SetCapability(cap, true)) {
+        glEnable(cap);
+    }
+}
+
+void GLStateCache::Disable(GLenum cap)
+{
+    if (SetCapability(cap, false)) {
+        glDisable(cap);
+    }
+}
+
+void GLStateCache::DepthMask(GLboolean enabled)
+{
+    if (Skip(((known_ & KNOWN_DEPTH_MASK) != 0) && (depthMask_ == enabled))) {
+        return;
+    }
+    glDepthMask(enabled);
+    depthMask_ = enabled;
+    known_ |= KNOWN_DEPTH_MASK;
+}
+
+void GLStateCache::BlendFunc(GLenum source, GLenum destination)
+{
+    BlendFuncSeparate(source, destination, source, destination);
+}
+
+void GLStateCache::BlendFuncSeparate(GLenum sourceRgb, GLenum destinationRgb, GLenum sourceAlpha,
+                                     GLenum destinationAlpha)
+{
+    if (Skip(((known_ & KNOWN_BLEND_FUNC) != 0) && (blendFunc_[0] == sourceRgb) &&
+             (blendFunc_[1] == destinationRgb) && (blendFunc_[2] == sourceAlpha) &&
+             (blendFunc_[3] == destinationAlpha))) {
+        return;
+    }
+    glBlendFuncSeparate(sourceRgb, destinationRgb, sourceAlpha, destinationAlpha);
+    blendFunc_[0] = sourceRgb;
+    blendFunc_[1] = destinationRgb;
+    blendFunc_[2] = sourceAlpha;
+    blendFunc_[3] = destinationAlpha;
+    known_ |= KNOWN_BLEND_FUNC;
+}
+
+void GLStateCache::OnProgramDeleted(GLuint program)
+{
+    // Deleting the current program leaves it in use until another one is bound.
+    if (program_ == program) {
+        known_ &= ~KNOWN_PROGRAM;
+    }
+}
+
+void GLStateCache::OnBufferDeleted(GLuint buffer)
+{
+    // GL unbinds deleted buffers from the current bindings.
+    if (arrayBuffer_ == buffer) {
+        arrayBuffer_ = 0;
+    }
+    if (uniformBuffer_ == buffer) {
+        uniformBuffer_ = 0;
+    }
+    for (GLuint i = 0; i < MAX_TRACKED_UNIFORM_BINDINGS; ++i) {
+        if (uniformBindings_[i] == buffer) {
+            uniformBindings_[i] = 0;
+        }
+    }
+    auto iter = vertexArrays_.find(vertexArray_);
+    if ((iter != vertexArrays_.end()) && (iter->second.elementBuffer == buffer)) {
+        iter->second.elementBuffer = 0;
+    }
+}
+
+void GLStateCache::OnVertexArrayDeleted(GLuint vao)
+{
+    vertexArrays_.erase(vao);
+    if (vertexArray_ == vao) {
+        vertexArray_ = 0;
+    }
+}
+
+void GLStateCache::OnTextureDeleted(GLuint texture)
+{
+    // GL unbinds deleted textures from the current bindings.
+    if (texture2d_ == texture) {
+        texture2d_ = 0;
+    }
+}
+
+void GLStateCache::OnFramebufferDeleted(GLuint framebuffer)
+{
+    // Deleting the bound framebuffer reverts the binding to the window surface.
+    if (framebuffer_ == framebuffer) {
+        framebuffer_ = 0;
+    }
+}
+} // namespace NativeXComponentSample
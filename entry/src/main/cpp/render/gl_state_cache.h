@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_GL_STATE_CACHE_H
+#define NATIVE_XCOMPONENT_GL_STATE_CACHE_H
+
+#include <epoxy/egl.h>
+#include <epoxy/gl.h>
+#include <cstdint>
+#include <unordered_map>
+
+namespace NativeXComponentSample {
+/**
+ * Shadow copy of the EGL/GL state EGLCore touches. Setters only reach the driver
+ * when the value actually changes. All GL state changes for the owning context
+ * must go through this cache, otherwise call Invalidate().
+ */
+class GLStateCache {
+public:
+    void Invalidate();
+    bool MakeCurrent(EGLDisplay display, EGLSurface surface, EGLContext context);
+    void ReleaseCurrent();
+    void UseProgram(GLuint program);
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    void Scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+    void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+    void BindBuffer(GLenum target, GLuint buffer);
+    void BindUniformBufferBase(GLuint index, GLuint buffer);
+    void BindVertexArray(GLuint vao);
+    // GL_FRAMEBUFFER (draw and read); 0 is the window surface.
+    void BindFramebuffer(GLuint framebuffer);
+    // Texture unit 0 only; EGLCore never changes the active texture unit.
+    void BindTexture(GLenum target, GLuint texture);
+    void EnableVertexAttribArray(GLuint index);
+    void DisableVertexAttribArray(GLuint index);
+    void VertexAttrib4fv(GLuint index, const GLfloat* value);
+    void Enable(GLenum cap);
+    void Disable(GLenum cap);
+    void DepthMask(GLboolean enabled);
+    void BlendFunc(GLenum source, GLenum destination);
+    void BlendFuncSeparate(GLenum sourceRgb, GLenum destinationRgb, GLenum sourceAlpha, GLenum destinationAlpha);
+    void OnProgramDeleted(GLuint program);
+    void OnBufferDeleted(GLuint buffer);
+    void OnVertexArrayDeleted(GLuint vao);
+    void OnTextureDeleted(GLuint texture);
+    void OnFramebufferDeleted(GLuint framebuffer);
+
+    uint64_t SkippedCalls() const
+    {
+        return skippedCalls_;
+    }
+
+    static constexpr GLuint MAX_TRACKED_ATTRIBS = 16;
+    static constexpr GLuint MAX_TRACKED_UNIFORM_BINDINGS = 8;
+
+private:
+    enum KnownState : uint32_t {
+        KNOWN_PROGRAM = 1 << 0,
+        KNOWN_VIEWPORT = 1 << 1,
+        KNOWN_CLEAR_COLOR = 1 << 2,
+        KNOWN_ARRAY_BUFFER = 1 << 3,
+        KNOWN_UNIFORM_BUFFER = 1 << 4,
+        KNOWN_VERTEX_ARRAY = 1 << 5,
+        KNOWN_DEPTH_MASK = 1 << 6,
+        KNOWN_BLEND_FUNC = 1 << 7,
+        KNOWN_TEXTURE_2D = 1 << 8,
+        KNOWN_FRAMEBUFFER = 1 << 9,
+        KNOWN_SCISSOR = 1 << 10,
+    };
+
+    /**
+     * Vertex array object state; bits are only trusted once set through the cache.
+     */
+    struct VertexArrayState {
+        uint32_t knownAttribs = 0;
+        uint32_t enabledAttribs = 0;
+        bool elementBufferKnown = false;
+        GLuint elementBuffer = 0;
+    };
+
+    bool SetCapability(GLenum cap, bool enabled);
+    bool Skip(bool unchanged)
+    {
+        if (unchanged) {
+            ++skippedCalls_;
+        }
+        return unchanged;
+    }
+
+    EGLDisplay display_ = EGL_NO_DISPLAY;
+    EGLSurface surface_ = EGL_NO_SURFACE;
+    EGLContext context_ = EGL_NO_CONTEXT;
+    uint32_t known_ = 0;
+    GLuint program_ = 0;
+    GLint viewport_[4] = {};
+    GLint scissor_[4] = {};
+    GLfloat clearColor_[4] = {};
+    GLuint arrayBuffer_ = 0;
+    GLuint uniformBuffer_ = 0;
+    GLuint vertexArray_ = 0;
+    GLuint texture2d_ = 0;
+    GLuint framebuffer_ = 0;
+    GLboolean depthMask_ = GL_TRUE;
+    GLenum blendFunc_[4] = {};
+    GLuint uniformBindings_[MAX_TRACKED_UNIFORM_BINDINGS] = {};
+    uint32_t knownUniformBindings_ = 0;
+    std::unordered_map<GLuint, VertexArrayState> vertexArrays_;
+    GLfloat attribValues_[MAX_TRACKED_ATTRIBS][4] = {};
+    uint32_t knownAttribValues_ = 0;
+    std::unordered_map<GLenum, bool> capabilities_;
+    uint64_t skippedCalls_ = 0;
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_GL_STATE_CACHE_H
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "layer_cache.h"
+
+#include <hilog/log.h>
+
+#include "../common/common.h"
+
+namespace NativeXComponentSample {
+namespace {
+/**
+ * Bytes per layer pixel: RGBA8 color plus 24-bit depth (stored as 32 bits).
+ */
+const size_t LAYER_BYTES_PER_PIXEL = 8;
+
+// Storage extent for a content extent: the next multiple of SIZE_BUCKET.
+GLsizei BucketSize(GLsizei size)
+{
+    return ((size + LayerCache::SIZE_BUCKET - 1) / LayerCache::SIZE_BUCKET) * LayerCache::SIZE_BUCKET;
+}
+} // namespace
+
+bool LayerCache::Init(GLStateCache* stateCache)
+{
+    if (stateCache == nullptr) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "LayerCache", "Init: param error");
+        return false;
+    }
+    stateCache_ = stateCache;
+    useClock_ = 0;
+    stats_ = {};
+    return true;
+}
+
+void LayerCache::Destroy()
+{
+    for (auto& entry : layers_) {
+        Free(entry.second);
+    }
+    layers_.clear();
+    stats_.layers = 0;
+    stateCache_ = nullptr;
+}
+
+void LayerCache::SetBudget(size_t budgetBytes)
+{
+    budgetBytes_ = budgetBytes;
+    MakeRoom(0);
+}
+
+CachedLayer* LayerCache::Acquire(uint32_t id, GLsizei width, GLsizei height)
+{
+    if ((stateCache_ == nullptr) || (width <= 0) || (height <= 0)) {
+        return nullptr;
+    }
+    GLsizei storageWidth = BucketSize(width);
+    GLsizei storageHeight = BucketSize(height);
+    auto iter = layers_.find(id);
+    if ((iter != layers_.end()) && (iter->second.storageWidth == storageWidth) &&
+        (iter->second.storageHeight == storageHeight)) {
+        CachedLayer& layer = iter->second;
+        // Resizes within the bucket keep the storage; only the content is stale.
+        if ((layer.width != width) || (layer.height != height)) {
+            layer.width = width;
+            layer.height = height;
+            layer.valid = false;
+        } else if (layer.valid) {
+            ++stats_.hits;
+        }
+        layer.lastUse = ++useClock_;
+        return &layer;
+    }
+
+    // New or crossed a bucket: the old storage goes first so it never counts against the new one.
+    Release(id);
+    size_t bytes = static_cast<size_t>(storageWidth) * static_cast<size_t>(storageHeight) * LAYER_BYTES_PER_PIXEL;
+    if ((bytes > budgetBytes_) || !MakeRoom(bytes)) {
+        return nullptr;
+    }
+    CachedLayer& layer = layers_[id];
+    layer = {};
+    layer.id = id;
+    if (!Allocate(layer, storageWidth, storageHeight)) {
+        layers_.erase(id);
+        return nullptr;
+    }
+    layer.width = width;
+    layer.height = height;
+    ++stats_.reallocations;
+    layer.lastUse = ++useClock_;
+    stats_.layers = static_cast<uint32_t>(layers_.size());
+    return &layer;
+}
+
+bool LayerCache::BeginRender(CachedLayer& layer)
+{
+    if ((stateCache_ == nullptr) || (layer.framebuffer == 0)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "LayerCache", "BeginRender: param error");
+        return false;
+    }
+    stateCache_->BindFramebuffer(layer.framebuffer);
+    stateCache_->Viewport(0, 0, layer.width, layer.height);
+    stateCache_->ClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    stateCache_->DepthMask(GL_TRUE);
+    // The gl function has no return value.
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    ++stats_.renders;
+    return true;
+}
+
+void LayerCache::EndRender(CachedLayer& layer)
+{
+    layer.valid = true;
+    if (stateCache_ != nullptr) {
+        stateCache_->BindFramebuffer(0);
+    }
+}
+
+void LayerCache::Invalidate(uint32_t id)
+{
+    auto iter = layers_.find(id);
+    if (iter != layers_.end()) {
+        iter->second.valid = false;
+    }
+}
+
+void LayerCache::InvalidateAll()
+{
+    for (auto& entry : layers_) {
+        entry.second.valid = false;
+    }
+}
+
+void LayerCache::Release(uint32_t id)
+{
+    auto iter = layers_.find(id);
+    if (iter == layers_.end()) {
+        return;
+    }
+    Free(iter->second);
+    layers_.erase(iter);
+    stats_.layers = static_cast<uint32_t>(layers_.size());
+}
+
+bool LayerCache::Allocate(CachedLayer& layer, GLsizei width, GLsizei height)
+{
+    glGenFramebuffers(1, &layer.framebuffer);
+    glGenTextures(1, &layer.texture);
+    glGenRenderbuffers(1, &layer.depthBuffer);
+    if ((layer.framebuffer == 0) || (layer.texture == 0) || (layer.depthBuffer == 0)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "LayerCache", "Allocate: unable to create objects");
+        Free(layer);
+        return false;
+    }
+    layer.storageWidth = width;
+    layer.storageHeight = height;
+
+    // The gl function has no return value.
+    // Layers are composited 1:1, so no filtering or mipmaps are needed.
+    stateCache_->BindTexture(GL_TEXTURE_2D, layer.texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindRenderbuffer(GL_RENDERBUFFER, layer.depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    stateCache_->BindFramebuffer(layer.framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layer.texture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, layer.depthBuffer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    stateCache_->BindFramebuffer(0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "LayerCache", "Allocate: incomplete framebuffer %{public}x",
+                     status);
+        Free(layer);
+        return false;
+    }
+    layer.bytes = static_cast<size_t>(width) * static_cast<size_t>(height) * LAYER_BYTES_PER_PIXEL;
+    stats_.bytes += layer.bytes;
+    return true;
+}
+
+void LayerCache::Free(CachedLayer& layer)
+{
+    if (stateCache_ != nullptr) {
+        stateCache_->OnFramebufferDeleted(layer.framebuffer);
+        stateCache_->OnTextureDeleted(layer.texture);
+    }
+    glDeleteFramebuffers(1, &layer.framebuffer);
+    glDeleteTextures(1, &layer.texture);
+    glDeleteRenderbuffers(1, &layer.depthBuffer);
+    layer.framebuffer = 0;
+    layer.texture = 0;
+    layer.depthBuffer = 0;
+    stats_.bytes -= layer.bytes;
+    layer.bytes = 0;
+    layer.valid = false;
+}
+
+bool LayerCache::MakeRoom(size_t bytes)
+{
+    while (stats_.bytes + bytes > budgetBytes_) {
+        auto victim = layers_.end();
+        for (auto iter = layers_.begin(); iter != layers_.end(); ++iter) {
+            if ((victim == layers_.end()) || (iter->second.lastUse < victim->second.lastUse)) {
+                victim = iter;
+            }
+        }
+        if (victim == layers_.end()) {
+            return false;
+        }
+        Free(victim->second);
+        layers_.erase(victim);
+        ++stats_.evictions;
+    }
+    stats_.layers = static_cast<uint32_t>(layers_.size());
+    return true;
+}
+} // namespace NativeXComponentSample
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_LAYER_CACHE_H
+#define NATIVE_XCOMPONENT_LAYER_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <epoxy/gl.h>
+#include <unordered_map>
+#include "render/gl_state_cache.h"
+
+namespace NativeXComponentSample {
+/**
+ * Off-screen render target of one cached layer: RGBA8 color texture plus a 24-bit depth
+ * buffer. The content covers the width x height corner at the origin of the
+ * storageWidth x storageHeight storage. valid is cleared by LayerCache::Invalidate() and
+ * set once the content is rendered.
+ */
+struct CachedLayer {
+    uint32_t id;
+    GLuint framebuffer;
+    GLuint texture;
+    GLuint depthBuffer;
+    GLsizei width;
+    GLsizei height;
+    GLsizei storageWidth;
+    GLsizei storageHeight;
+    size_t bytes;
+    bool valid;
+    uint64_t lastUse;
+};
+
+/**
+ * Counters since Init(); bytes is the memory currently held by cached layers.
+ */
+struct LayerCacheStats {
+    uint32_t layers;
+    size_t bytes;
+    uint64_t hits;
+    uint64_t renders;
+    uint64_t evictions;
+    uint64_t reallocations;
+};
+
+/**
+ * Keeps rendered layers in textures so unchanged content is composited as one textured
+ * quad instead of being redrawn. Layers are keyed by an owner-chosen id. The memory held
+ * by all layers stays within the budget; when a new layer does not fit, the least recently
+ * acquired layers are evicted, and a layer larger than the whole budget is not cached at
+ * all. Layer contents are premultiplied by alpha. Must be used on the thread that owns
+ * the GL context.
+ */
+class LayerCache {
+public:
+    // The budget survives Init()/Destroy(), so it can be set before the context exists.
+    bool Init(GLStateCache* stateCache);
+    void Destroy();
+    void SetBudget(size_t budgetBytes);
+    // Returns the layer at the given size; nullptr when it cannot fit the budget. Storage is
+    // rounded up to SIZE_BUCKET and only reallocated when the size leaves its bucket, so a
+    // live resize mostly just re-renders. The pointer stays valid until the layer is
+    // evicted or released.
+    CachedLayer* Acquire(uint32_t id, GLsizei width, GLsizei height);
+    // Binds the layer's framebuffer and clears it to transparent; the viewport is the
+    // layer's content size afterwards.
+    bool BeginRender(CachedLayer& layer);
+    // Marks the content valid and rebinds the window surface; callers restore their viewport.
+    void EndRender(CachedLayer& layer);
+    void Invalidate(uint32_t id);
+    void InvalidateAll();
+    void Release(uint32_t id);
+    const LayerCacheStats& Stats() const
+    {
+        return stats_;
+    }
+
+    static constexpr size_t DEFAULT_BUDGET_BYTES = 32 * 1024 * 1024;
+    static constexpr GLsizei SIZE_BUCKET = 128;
+
+private:
+    bool Allocate(CachedLayer& layer, GLsizei width, GLsizei height);
+    void Free(CachedLayer& layer);
+    bool MakeRoom(size_t bytes);
+
+    GLStateCache* stateCache_ = nullptr;
+    size_t budgetBytes_ = DEFAULT_BUDGET_BYTES;
+    uint64_t useClock_ = 0;
+    std::unordered_map<uint32_t, CachedLayer> layers_;
+    LayerCacheStats stats_ = {};
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_LAYER_CACHE_H
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "program_cache.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <hilog/log.h>
+#include <vector>
+
+#include "../common/common.h"
+
+namespace NativeXComponentSample {
+namespace {
+/**
+ * File header magic ("XCPB") and layout version; other files are ignored.
+ */
+const uint32_t CACHE_MAGIC = 0x42504358;
+const uint32_t CACHE_VERSION = 1;
+
+/**
+ * Binaries above this size are treated as corrupt.
+ */
+const uint32_t MAX_BINARY_LENGTH = 16 * 1024 * 1024;
+
+/**
+ * 64-bit FNV-1a parameters.
+ */
+const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+/**
+ * Precedes the binary in every cache file.
+ */
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t length;
+};
+
+// Hashes the string including its terminator, so adjacent strings cannot run together.
+uint64_t HashString(uint64_t hash, const char* text)
+{
+    if (text == nullptr) {
+        text = "";
+    }
+    const char* p = text;
+    do {
+        hash ^= static_cast<uint8_t>(*p);
+        hash *= FNV_PRIME;
+    } while (*p++ != '\0');
+    return hash;
+}
+
+const char* GLString(GLenum name)
+{
+    return reinterpret_cast<const char*>(glGetString(name));
+}
+} // namespace
+
+ProgramCache& ProgramCache::Instance()
+{
+    static ProgramCache cache;
+    return cache;
+}
+
+void ProgramCache::SetDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_ = directory;
+}
+
+ProgramCacheStats ProgramCache::Stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::string ProgramCache::EntryPath(const char* vertexSource, const char* fragmentSource, uint64_t& key) const
+{
+    std::string directory;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        directory = directory_;
+    }
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (directory.empty() || (formats <= 0)) {
+        return std::string();
+    }
+    // The version string carries the driver build, e.g. "OpenGL ES 3.1 Mesa 24.0.0 (git-...)".
+    key = FNV_OFFSET_BASIS;
+    key = HashString(key, vertexSource);
+    key = HashString(key, fragmentSource);
+    key = HashString(key, GLString(GL_VENDOR));
+    key = HashString(key, GLString(GL_RENDERER));
+    key = HashString(key, GLString(GL_VERSION));
+    key = HashString(key, GLString(GL_SHADING_LANGUAGE_VERSION));
+    char name[32] = {};
+    snprintf(name, sizeof(name), "/program_%016" PRIx64 ".bin", key);
+    return directory + name;
+}
+
+GLuint ProgramCache::Load(const char* vertexSource, const char* fragmentSource)
+{
+    uint64_t key = 0;
+    std::string path = EntryPath(vertexSource, fragmentSource, key);
+    if (path.empty()) {
+        return 0;
+    }
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.misses;
+        return 0;
+    }
+    CacheHeader header = {};
+    std::vector<uint8_t> binary;
+    bool valid = (fread(&header, sizeof(header), 1, file) == 1) && (header.magic == CACHE_MAGIC) &&
+        (header.version == CACHE_VERSION) && (header.key == key) && (header.length > 0) &&
+        (header.length <= MAX_BINARY_LENGTH);
+    if (valid) {
+        binary.resize(header.length);
+        valid = fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    fclose(file);
+
+    GLuint program = 0;
+    if (valid) {
+        program = glCreateProgram();
+        // The gl function has no return value.
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked == 0) {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (program == 0) {
+        // Corrupt or rejected by the driver: drop it, the caller compiles and stores anew.
+        OH_LOG_Print(LOG_APP, LOG_INFO, LOG_PRINT_DOMAIN, "ProgramCache", "Load: binary rejected, recompiling");
+        remove(path.c_str());
+        ++stats_.rejected;
+        ++stats_.misses;
+        return 0;
+    }
+    ++stats_.hits;
+    return program;
+}
+
+bool ProgramCache::Store(GLuint program, const char* vertexSource, const char* fragmentSource)
+{
+    uint64_t key = 0;
+    std::string path = EntryPath(vertexSource, fragmentSource, key);
+    if (path.empty() || (program == 0)) {
+        return false;
+    }
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if ((length <= 0) || (static_cast<uint32_t>(length) > MAX_BINARY_LENGTH)) {
+        return false;
+    }
+    std::vector<uint8_t> binary(static_cast<size_t>(length));
+    CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, key, 0, 0 };
+    GLsizei written = 0;
+    GLenum format = GL_NONE;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) {
+        return false;
+    }
+    header.format = format;
+    header.length = static_cast<uint32_t>(written);
+
+    // Written to a temporary name and renamed, so a crash never leaves a torn entry.
+    std::string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (file == nullptr) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "ProgramCache", "Store: unable to open %{public}s",
+                     temporary.c_str());
+        return false;
+    }
+    bool ok = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+        (fwrite(binary.data(), 1, header.length, file) == header.length);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || (rename(temporary.c_str(), path.c_str()) != 0)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "ProgramCache", "Store: write failed");
+        remove(temporary.c_str());
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.stored;
+    return true;
+}
+} // namespace NativeXComponentSample
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_PROGRAM_CACHE_H
+#define NATIVE_XCOMPONENT_PROGRAM_CACHE_H
+
+#include <cstdint>
+#include <epoxy/gl.h>
+#include <mutex>
+#include <string>
+
+namespace NativeXComponentSample {
+/**
+ * Hits and misses since process start; rejected counts binaries the driver refused.
+ */
+struct ProgramCacheStats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t rejected;
+    uint32_t stored;
+};
+
+/**
+ * Persistent cache of linked program binaries in the app's cache directory, so startup
+ * skips shader compilation (GLSL to NIR to SPIR-V to a Vulkan pipeline under zink).
+ * Entries are keyed by a hash of both shader sources and the GL vendor, renderer,
+ * version and GLSL version strings, so a driver update simply misses. Every failure
+ * falls back to compiling from source: Load() returns 0 and the caller links normally,
+ * then passes the result to Store(). Disabled until a directory is set. Load() and
+ * Store() must be called with a current context.
+ */
+class ProgramCache {
+public:
+    static ProgramCache& Instance();
+
+    // Any thread; usually the ability's cacheDir, set once before the first surface.
+    void SetDirectory(const std::string& directory);
+    // Linked program from a cached binary, or 0.
+    GLuint Load(const char* vertexSource, const char* fragmentSource);
+    // Writes the binary of a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+    bool Store(GLuint program, const char* vertexSource, const char* fragmentSource);
+    ProgramCacheStats Stats() const;
+
+private:
+    ProgramCache() = default;
+    ProgramCache(const ProgramCache&) = delete;
+    ProgramCache& operator=(const ProgramCache&) = delete;
+
+    // Empty when the cache is disabled or the driver has no binary formats.
+    std::string EntryPath(const char* vertexSource, const char* fragmentSource, uint64_t& key) const;
+
+    mutable std::mutex mutex_;
+    std::string directory_;
+    ProgramCacheStats stats_ = {};
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_PROGRAM_CACHE_H
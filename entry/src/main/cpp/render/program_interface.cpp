@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "program_interface.h"
+
+#include <hilog/log.h>
+#include <vector>
+
+#include "../common/common.h"
+
+namespace NativeXComponentSample {
+namespace {
+/**
+ * Suffix GL reports for the first element of array uniforms.
+ */
+const char ARRAY_SUFFIX[] = "[0]";
+const size_t ARRAY_SUFFIX_LEN = sizeof(ARRAY_SUFFIX) - 1;
+
+std::string TrimArraySuffix(const char* name, GLsizei length)
+{
+    std::string result(name, length);
+    if ((result.size() > ARRAY_SUFFIX_LEN) &&
+        (result.compare(result.size() - ARRAY_SUFFIX_LEN, ARRAY_SUFFIX_LEN, ARRAY_SUFFIX) == 0)) {
+        result.resize(result.size() - ARRAY_SUFFIX_LEN);
+    }
+    return result;
+}
+} // namespace
+
+bool ProgramInterface::Reflect(GLuint program)
+{
+    Clear();
+    if (program == 0) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "ProgramInterface", "Reflect: program is null");
+        return false;
+    }
+    program_ = program;
+
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+    std::vector<char> name(maxLength + 1, '\0');
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveAttrib(program, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+        attributes_[std::string(name.data(), length)] = glGetAttribLocation(program, name.data());
+    }
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    name.assign(maxLength + 1, '\0');
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+        GLint location = glGetUniformLocation(program, name.data());
+        // Members of uniform blocks have no location and are not addressable this way.
+        if (location != INVALID_LOCATION) {
+            uniforms_[TrimArraySuffix(name.data(), length)] = location;
+        }
+    }
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+    name.assign(maxLength + 1, '\0');
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        glGetActiveUniformBlockName(program, i, static_cast<GLsizei>(name.size()), &length, name.data());
+        uniformBlocks_[std::string(name.data(), length)] = static_cast<GLuint>(i);
+    }
+    return true;
+}
+
+void ProgramInterface::Clear()
+{
+    program_ = 0;
+    attributes_.clear();
+    uniforms_.clear();
+    uniformBlocks_.clear();
+}
+
+GLint ProgramInterface::Attribute(const char* name) const
+{
+    auto iter = attributes_.find(name);
+    if (iter == attributes_.end()) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "ProgramInterface",
+                     "attribute %{public}s is not active", name);
+        return INVALID_LOCATION;
+    }
+    return iter->second;
+}
+
+GLint ProgramInterface::Uniform(const char* name) const
+{
+    auto iter = uniforms_.find(name);
+    if (iter == uniforms_.end()) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "ProgramInterface",
+                     "uniform %{public}s is not active", name);
+        return INVALID_LOCATION;
+    }
+    return iter->second;
+}
+
+GLuint ProgramInterface::UniformBlock(const char* name) const
+{
+    auto iter = uniformBlocks_.find(name);
+    if (iter == uniformBlocks_.end()) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "ProgramInterface",
+                     "uniform block %{public}s is not active", name);
+        return GL_INVALID_INDEX;
+    }
+    return iter->second;
+}
+} // namespace NativeXComponentSample
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_PROGRAM_INTERFACE_H
+#define NATIVE_XCOMPONENT_PROGRAM_INTERFACE_H
+
+#include <epoxy/gl.h>
+#include <string>
+#include <unordered_map>
+
+namespace NativeXComponentSample {
+/**
+ * Active attributes, uniforms and uniform blocks of a linked program, reflected once at link time.
+ * Lookups by name are meant for setup code that fills typed interface structs;
+ * per-frame paths use the cached locations from those structs.
+ */
+class ProgramInterface {
+public:
+    static constexpr GLint INVALID_LOCATION = -1;
+
+    bool Reflect(GLuint program);
+    void Clear();
+    GLint Attribute(const char* name) const;
+    GLint Uniform(const char* name) const;
+    GLuint UniformBlock(const char* name) const;
+    GLuint Program() const
+    {
+        return program_;
+    }
+
+private:
+    GLuint program_ = 0;
+    std::unordered_map<std::string, GLint> attributes_;
+    std::unordered_map<std::string, GLint> uniforms_;
+    std::unordered_map<std::string, GLuint> uniformBlocks_;
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_PROGRAM_INTERFACE_H
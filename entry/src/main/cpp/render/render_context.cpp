@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render_context.h"
+
+#include <hilog/log.h>
+
+#include "../common/common.h"
+#include "egl_device.h"
+
+namespace NativeXComponentSample {
+bool RenderContext::Init()
+{
+    if (Ready()) {
+        return true;
+    }
+    // Display and config are set up once per process; the context joins the device's
+    // share group, so shared objects outlive it.
+    context_ = EGLDevice::Instance().CreateContext();
+    if (context_ == EGL_NO_CONTEXT) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "RenderContext", "context creation failed");
+        return false;
+    }
+    display_ = EGLDevice::Instance().Display();
+    surfaceless_ = EGLDevice::Instance().HasExtension("EGL_KHR_surfaceless_context");
+    return true;
+}
+
+void RenderContext::Destroy()
+{
+    if (!Ready()) {
+        return;
+    }
+    ReleaseCurrent();
+    EGLDevice::Instance().DestroyContext(context_);
+    context_ = EGL_NO_CONTEXT;
+}
+
+EGLSurface RenderContext::CreateWindowSurface(void* window)
+{
+    if (!Ready()) {
+        return EGL_NO_SURFACE;
+    }
+    return EGLDevice::Instance().CreateWindowSurface(window);
+}
+
+void RenderContext::DestroySurface(EGLSurface surface)
+{
+    if (surface == EGL_NO_SURFACE) {
+        return;
+    }
+    // A current surface would only be destroyed once released, and the cache would
+    // still consider it bound. Staying current without a surface keeps the cached state.
+    if (surface == eglGetCurrentSurface(EGL_DRAW)) {
+        if (!surfaceless_ || !stateCache_.MakeCurrent(display_, EGL_NO_SURFACE, context_)) {
+            ReleaseCurrent();
+        }
+    }
+    EGLDevice::Instance().DestroySurface(surface);
+}
+
+bool RenderContext::MakeCurrent(EGLSurface surface)
+{
+    if (!Ready() || ((surface == EGL_NO_SURFACE) && !surfaceless_)) {
+        return false;
+    }
+    // Same context for every surface, so the cached GL state stays valid across switches.
+    return stateCache_.MakeCurrent(display_, surface, context_);
+}
+
+void RenderContext::ReleaseCurrent()
+{
+    stateCache_.ReleaseCurrent();
+}
+
+bool RenderContext::HasExtension(const char* name) const
+{
+    return EGLDevice::Instance().HasExtension(name);
+}
+} // namespace NativeXComponentSample
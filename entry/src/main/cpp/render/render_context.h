@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_RENDER_CONTEXT_H
+#define NATIVE_XCOMPONENT_RENDER_CONTEXT_H
+
+#include <epoxy/egl.h>
+#include <epoxy/gl.h>
+#include "render/gl_state_cache.h"
+
+namespace NativeXComponentSample {
+/**
+ * The single context every surface of the render thread renders with, created in the
+ * EGLDevice share group. Surfaces only own their EGLSurface and are made current in turn,
+ * so switching between them never switches contexts. The state cache belongs to the
+ * context and is shared by all surfaces. Render thread only.
+ */
+class RenderContext {
+public:
+    bool Init();
+    void Destroy();
+    bool Ready() const
+    {
+        return context_ != EGL_NO_CONTEXT;
+    }
+    EGLSurface CreateWindowSurface(void* window);
+    void DestroySurface(EGLSurface surface);
+    // EGL_NO_SURFACE binds the context alone, if EGL_KHR_surfaceless_context is supported.
+    bool MakeCurrent(EGLSurface surface);
+    // Detaches the context from the thread and from whatever surface it was drawing to.
+    void ReleaseCurrent();
+    bool HasExtension(const char* name) const;
+    EGLDisplay Display() const
+    {
+        return display_;
+    }
+    GLStateCache& StateCache()
+    {
+        return stateCache_;
+    }
+
+private:
+    EGLDisplay display_ = EGL_NO_DISPLAY;
+    EGLContext context_ = EGL_NO_CONTEXT;
+    bool surfaceless_ = false;
+    GLStateCache stateCache_;
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_RENDER_CONTEXT_H
@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render_thread.h"
+
+#include <hilog/log.h>
+#include <pthread.h>
+
+#include "../common/common.h"
+
+namespace NativeXComponentSample {
+namespace {
+/**
+ * Render thread name, visible in traces.
+ */
+const char RENDER_THREAD_NAME[] = "xc_render";
+
+/**
+ * Packing of a latest-value size: width in the high, height in the low half.
+ */
+const uint64_t SIZE_SHIFT = 32;
+const uint64_t SIZE_MASK = 0xFFFFFFFF;
+} // namespace
+
+RenderThread::RenderThread(Handler handler) : handler_(std::move(handler))
+{
+    for (size_t i = 0; i < QUEUE_CAPACITY; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+RenderThread::~RenderThread()
+{
+    Stop();
+}
+
+bool RenderThread::Start()
+{
+    if (running_.exchange(true)) {
+        return true;
+    }
+    thread_ = std::thread(&RenderThread::Run, this);
+    return true;
+}
+
+void RenderThread::Stop()
+{
+    if (!running_.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wakeCond_.notify_all();
+        idleCond_.notify_all();
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool RenderThread::IsRenderThread() const
+{
+    return std::this_thread::get_id() == thread_.get_id();
+}
+
+bool RenderThread::Post(const RenderCommand& command, uint64_t* ticket)
+{
+    if (!TryPush(command, ticket)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "RenderThread", "Post: command queue is full");
+        return false;
+    }
+    return true;
+}
+
+bool RenderThread::PostWait(const RenderCommand& command, uint64_t* ticket)
+{
+    if (IsRenderThread()) {
+        // Waiting here would deadlock: only this thread frees slots.
+        return Post(command, ticket);
+    }
+    // Every executed command frees a slot, so a full queue drains while the thread runs.
+    while (running_.load()) {
+        if (TryPush(command, ticket)) {
+            return true;
+        }
+        std::this_thread::yield();
+    }
+    OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "RenderThread", "PostWait: render thread stopped");
+    return false;
+}
+
+bool RenderThread::TryPush(const RenderCommand& command, uint64_t* ticket)
+{
+    uint64_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &slots_[pos % QUEUE_CAPACITY];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+        if (diff == 0) {
+            // Sequentially consistent so the consumer's sleep check below cannot miss this push.
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->command = command;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    if (ticket != nullptr) {
+        *ticket = pos;
+    }
+
+    // Only touch the mutex when the render thread is actually parked.
+    if (sleeping_.load()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wakeCond_.notify_one();
+    }
+    return true;
+}
+
+bool RenderThread::PostCoalesced(const RenderCommand& command)
+{
+    std::atomic<uint32_t>* pending = PendingTypes(command.surface);
+    if (pending == nullptr) {
+        return Post(command);
+    }
+    // Producers only ever look at these bits, never at a queued command, which the render
+    // thread may be taking at the same time.
+    uint32_t bit = 1U << static_cast<uint32_t>(command.type);
+    if ((pending->fetch_or(bit, std::memory_order_acq_rel) & bit) != 0) {
+        coalesced_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    RenderCommand coalesced = command;
+    coalesced.coalesced = true;
+    if (!Post(coalesced)) {
+        pending->fetch_and(~bit, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+bool RenderThread::PostLatest(const RenderCommand& command)
+{
+    SurfaceSlot* slot = FindSurfaceSlot(command.surface);
+    if (slot == nullptr) {
+        // Unkeyed or out of slots: every command runs.
+        return Post(command);
+    }
+    // Size first, then the queued flag: the render thread clears the flag before reading,
+    // so whichever side loses the race still sees the newest size.
+    slot->size.store((command.width << SIZE_SHIFT) | (command.height & SIZE_MASK), std::memory_order_release);
+    if (slot->queued.exchange(true, std::memory_order_acq_rel)) {
+        coalesced_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    RenderCommand latest = command;
+    latest.latest = true;
+    latest.generation = slot->generation.load(std::memory_order_acquire);
+    if (!Post(latest)) {
+        slot->queued.store(false, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+void RenderThread::BreakLatest(uint32_t surface)
+{
+    SurfaceSlot* slot = FindSurfaceSlot(surface);
+    if (slot == nullptr) {
+        return;
+    }
+    // Commands already queued keep their own values; the next PostLatest() queues a new one.
+    slot->generation.fetch_add(1);
+    slot->queued.store(false, std::memory_order_release);
+}
+
+bool RenderThread::AcquireSurfaceSlot(uint32_t surface)
+{
+    if (surface == 0) {
+        return false;
+    }
+    if (FindSurfaceSlot(surface) != nullptr) {
+        return true;
+    }
+    for (SurfaceSlot& slot : surfaceSlots_) {
+        uint32_t owner = 0;
+        if (slot.surface.compare_exchange_strong(owner, surface)) {
+            return true;
+        }
+    }
+    OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "RenderThread", "AcquireSurfaceSlot: no free slot");
+    return false;
+}
+
+void RenderThread::ReleaseSurfaceSlot(uint32_t surface)
+{
+    SurfaceSlot* slot = FindSurfaceSlot(surface);
+    if (slot == nullptr) {
+        return;
+    }
+    // Reset before giving up ownership, so the next surface starts from an empty slot.
+    slot->size.store(0, std::memory_order_relaxed);
+    slot->queued.store(false, std::memory_order_relaxed);
+    slot->pending.store(0, std::memory_order_relaxed);
+    slot->surface.store(0, std::memory_order_release);
+}
+
+RenderThread::SurfaceSlot* RenderThread::FindSurfaceSlot(uint32_t surface)
+{
+    if (surface == 0) {
+        return nullptr;
+    }
+    // Released slots leave holes, so every slot is checked.
+    for (SurfaceSlot& slot : surfaceSlots_) {
+        if (slot.surface.load(std::memory_order_acquire) == surface) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+std::atomic<uint32_t>* RenderThread::PendingTypes(uint32_t surface)
+{
+    if (surface == 0) {
+        return &broadcastPending_;
+    }
+    SurfaceSlot* slot = FindSurfaceSlot(surface);
+    return (slot != nullptr) ? &slot->pending : nullptr;
+}
+
+void RenderThread::ResolveCoalesced(const RenderCommand& command)
+{
+    std::atomic<uint32_t>* pending = PendingTypes(command.surface);
+    if (pending == nullptr) {
+        return;
+    }
+    // Cleared before the handler runs: requests from now on need an execution of their own.
+    pending->fetch_and(~(1U << static_cast<uint32_t>(command.type)), std::memory_order_acq_rel);
+}
+
+void RenderThread::ResolveLatest(RenderCommand& command)
+{
+    SurfaceSlot* slot = FindSurfaceSlot(command.surface);
+    if (slot == nullptr) {
+        return;
+    }
+    // A command from before a BreakLatest() keeps the values it was posted with: newer ones
+    // belong after the break. Checked again after the read, in case the break raced with it.
+    if (slot->generation.load(std::memory_order_acquire) != command.generation) {
+        return;
+    }
+    slot->queued.exchange(false, std::memory_order_acq_rel);
+    uint64_t size = slot->size.load(std::memory_order_acquire);
+    if (slot->generation.load(std::memory_order_acquire) != command.generation) {
+        return;
+    }
+    command.width = size >> SIZE_SHIFT;
+    command.height = size & SIZE_MASK;
+}
+
+void RenderThread::WaitIdle(uint64_t ticket)
+{
+    if (IsRenderThread()) {
+        return;
+    }
+    idleWaiters_.fetch_add(1);
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idleCond_.wait(lock, [this, ticket] { return (completed_.load() > ticket) || !running_.load(); });
+    }
+    idleWaiters_.fetch_sub(1);
+}
+
+bool RenderThread::TryPop(RenderCommand& command, uint64_t& ticket)
+{
+    // Single consumer: only the render thread advances dequeuePos_.
+    uint64_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[pos % QUEUE_CAPACITY];
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+        return false;
+    }
+    command = slot.command;
+    ticket = pos;
+    slot.sequence.store(pos + QUEUE_CAPACITY, std::memory_order_release);
+    dequeuePos_.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+bool RenderThread::HasPending() const
+{
+    return enqueuePos_.load() != dequeuePos_.load(std::memory_order_relaxed);
+}
+
+void RenderThread::Execute(RenderCommand& command, uint64_t ticket)
+{
+    if (command.latest) {
+        ResolveLatest(command);
+    }
+    if (command.coalesced) {
+        ResolveCoalesced(command);
+    }
+    handler_(command);
+    completed_.store(ticket + 1);
+    if (idleWaiters_.load() > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idleCond_.notify_all();
+    }
+}
+
+void RenderThread::Run()
+{
+    pthread_setname_np(pthread_self(), RENDER_THREAD_NAME);
+    OH_LOG_Print(LOG_APP, LOG_INFO, LOG_PRINT_DOMAIN, "RenderThread", "render thread started");
+
+    RenderCommand command;
+    uint64_t ticket = 0;
+    while (running_.load()) {
+        if (TryPop(command, ticket)) {
+            Execute(command, ticket);
+            continue;
+        }
+        if (HasPending()) {
+            // A producer has claimed a slot but not published it yet.
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleeping_.store(true);
+        wakeCond_.wait(lock, [this] { return !running_.load() || HasPending(); });
+        sleeping_.store(false);
+    }
+    // Commands still queued own resources such as windows and cores; run them all before
+    // exiting, including ones whose producer has claimed a slot but not published it yet.
+    while (HasPending()) {
+        if (TryPop(command, ticket)) {
+            Execute(command, ticket);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    OH_LOG_Print(LOG_APP, LOG_INFO, LOG_PRINT_DOMAIN, "RenderThread", "render thread stopped");
+}
+} // namespace NativeXComponentSample
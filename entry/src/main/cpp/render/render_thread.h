@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_RENDER_THREAD_H
+#define NATIVE_XCOMPONENT_RENDER_THREAD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace NativeXComponentSample {
+/**
+ * Work items posted from the ArkTS/UI thread to the render thread.
+ */
+enum class RenderCommandType : uint8_t {
+    SURFACE_CREATED,
+    SURFACE_CHANGED,
+    SURFACE_DESTROYED,
+    // The XComponent itself is gone; its surface id is never used again. Surface 0 removes
+    // every surface at shutdown.
+    SURFACE_REMOVED,
+    DRAW_PATTERN,
+    CHANGE_COLOR,
+    // Presents a frame that was put off while the GPU still used its frame slot.
+    RETRY_FRAME,
+    // Vertex format benchmark; width is the frame count and height the shapes per frame.
+    BENCHMARK_SHAPES,
+};
+
+/**
+ * Plain-data command, copied by value into the queue so posting never allocates.
+ */
+struct RenderCommand {
+    RenderCommandType type = RenderCommandType::DRAW_PATTERN;
+    // Surface id the command is for (see PluginManager); 0 addresses every surface.
+    uint32_t surface = 0;
+    void* window = nullptr;
+    uint64_t width = 0;
+    uint64_t height = 0;
+    // Set by PostLatest(): width and height are the newest posted for the surface.
+    bool latest = false;
+    // Set by PostLatest(): the surface's BreakLatest() generation when the command was queued.
+    uint32_t generation = 0;
+    // Set by PostCoalesced(): taking it lets the next request of its type be queued.
+    bool coalesced = false;
+};
+
+/**
+ * Thread that owns the EGL context. Commands are pushed into a bounded lock-free
+ * multi-producer/single-consumer ring and executed in order by the handler.
+ */
+class RenderThread {
+public:
+    using Handler = std::function<void(const RenderCommand&)>;
+
+    explicit RenderThread(Handler handler);
+    ~RenderThread();
+    bool Start();
+    void Stop();
+    bool Post(const RenderCommand& command, uint64_t* ticket = nullptr);
+    // Like Post(), but waits for a free slot instead of failing on a full queue; for
+    // commands that must not be lost. Fails only once the thread has stopped.
+    bool PostWait(const RenderCommand& command, uint64_t* ticket = nullptr);
+    // Like Post(), but dropped while a command of the same type for the same surface is
+    // queued and not taken by the render thread yet, so bursts of requests cost one
+    // execution. Only the type and surface are compared. Surfaces without a slot post every
+    // command; commands for surface 0 (every surface) share one set of flags.
+    bool PostCoalesced(const RenderCommand& command);
+    // For state that only matters in its newest version, such as a surface size: while a
+    // command of the surface is still queued, only its width and height are replaced,
+    // so a burst costs one execution that sees the last values. Keyed by surface, so use
+    // it for one command type; never allocates. Surfaces without a slot post every command.
+    bool PostLatest(const RenderCommand& command);
+    // Ends PostLatest() coalescing for the surface: later values start a new command rather
+    // than updating one queued earlier. Call before posting a command those values must not
+    // be moved across, such as the surface being created or destroyed.
+    void BreakLatest(uint32_t surface);
+    // PostLatest() and PostCoalesced() state of one surface. Acquire on the posting thread
+    // before the surface's first command; release from the handler once the surface's last
+    // command has run.
+    bool AcquireSurfaceSlot(uint32_t surface);
+    void ReleaseSurfaceSlot(uint32_t surface);
+    uint64_t CoalescedCount() const
+    {
+        return coalesced_.load(std::memory_order_relaxed);
+    }
+    void WaitIdle(uint64_t ticket);
+    bool IsRenderThread() const;
+    // False once Stop() was called; the queue is still drained before the thread exits.
+    bool Running() const
+    {
+        return running_.load();
+    }
+
+private:
+    void Run();
+    void Execute(RenderCommand& command, uint64_t ticket);
+    bool TryPush(const RenderCommand& command, uint64_t* ticket);
+    bool TryPop(RenderCommand& command, uint64_t& ticket);
+    bool HasPending() const;
+    struct SurfaceSlot;
+    SurfaceSlot* FindSurfaceSlot(uint32_t surface);
+    std::atomic<uint32_t>* PendingTypes(uint32_t surface);
+    void ResolveLatest(RenderCommand& command);
+    void ResolveCoalesced(const RenderCommand& command);
+
+private:
+    static constexpr size_t QUEUE_CAPACITY = 256;
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    static constexpr size_t SURFACE_SLOTS = 16;
+
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        RenderCommand command;
+    };
+
+    /**
+     * Newest size of one surface (width in the high, height in the low 32 bits, so both
+     * change together), whether a command for it is queued and the generation it belongs
+     * to, bumped by BreakLatest(). Also one bit per RenderCommandType with a coalesced
+     * command queued. Owned by one surface between AcquireSurfaceSlot() and
+     * ReleaseSurfaceSlot().
+     */
+    struct SurfaceSlot {
+        std::atomic<uint32_t> surface{0};
+        std::atomic<uint64_t> size{0};
+        std::atomic<bool> queued{false};
+        std::atomic<uint32_t> generation{0};
+        std::atomic<uint32_t> pending{0};
+    };
+
+    Slot slots_[QUEUE_CAPACITY];
+    SurfaceSlot surfaceSlots_[SURFACE_SLOTS];
+    // PostCoalesced() bits of commands addressed to every surface.
+    std::atomic<uint32_t> broadcastPending_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> enqueuePos_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> dequeuePos_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> completed_{0};
+    std::atomic<bool> running_{false};
+    std::atomic<bool> sleeping_{false};
+    std::atomic<int32_t> idleWaiters_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::mutex mutex_;
+    std::condition_variable wakeCond_;
+    std::condition_variable idleCond_;
+    std::thread thread_;
+    Handler handler_;
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_RENDER_THREAD_H
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ring_buffer.h"
+
+#include <hilog/log.h>
+
+#include "../common/common.h"
+
+namespace NativeXComponentSample {
+namespace {
+/**
+ * Upper bound for a single wait on a ring region fence (one second).
+ */
+const GLuint64 RING_FENCE_TIMEOUT_NS = 1000000000;
+
+/**
+ * Map flags: the ring guarantees the range is not in use by the GPU.
+ */
+const GLbitfield RING_MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+
+GLintptr AlignUp(GLintptr value, GLsizeiptr alignment)
+{
+    // Alignment may be a vertex stride, so it is not required to be a power of two.
+    GLintptr remainder = value % alignment;
+    return (remainder == 0) ? value : (value + alignment - remainder);
+}
+} // namespace
+
+bool RingBuffer::Init(GLStateCache* stateCache, GLenum target, GLsizeiptr capacity)
+{
+    if ((stateCache == nullptr) || (capacity <= 0)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "RingBuffer", "Init: param error");
+        return false;
+    }
+    stateCache_ = stateCache;
+    target_ = target;
+    glGenBuffers(1, &buffer_);
+    if (buffer_ == 0) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "RingBuffer", "Init: unable to create buffer");
+        return false;
+    }
+
+    // The gl function has no return value.
+    stateCache_->BindBuffer(target_, buffer_);
+    glBufferData(target_, capacity, nullptr, GL_STREAM_DRAW);
+    capacity_ = capacity;
+    head_ = 0;
+    frameStart_ = 0;
+    frame_ = {};
+    frame_.capacity = capacity;
+    lastFrame_ = frame_;
+    return true;
+}
+
+void RingBuffer::Destroy()
+{
+    for (FrameRegion& region : inFlight_) {
+        glDeleteSync(region.fence);
+    }
+    inFlight_.clear();
+    if (stateCache_ != nullptr) {
+        stateCache_->OnBufferDeleted(buffer_);
+    }
+    glDeleteBuffers(1, &buffer_);
+    buffer_ = 0;
+    capacity_ = 0;
+}
+
+GLintptr RingBuffer::Fit(GLsizeiptr size, GLsizeiptr alignment)
+{
+    if (inFlight_.empty() && (head_ == frameStart_)) {
+        // Nothing is in use: restart at the front.
+        head_ = 0;
+        frameStart_ = 0;
+    }
+    GLintptr tail = inFlight_.empty() ? frameStart_ : inFlight_.front().start;
+    GLintptr offset = AlignUp(head_, alignment);
+    bool empty = inFlight_.empty() && (head_ == frameStart_);
+    if ((head_ >= tail) || empty) {
+        if (offset + size <= capacity_) {
+            return offset;
+        }
+        // Wrap around; the tail of the ring is skipped. Strictly less than tail so a
+        // full ring is never confused with an empty one.
+        if ((size < tail) || empty) {
+            ++frame_.wraps;
+            return 0;
+        }
+        return -1;
+    }
+    return (offset + size < tail) ? offset : -1;
+}
+
+bool RingBuffer::Reclaim(bool wait)
+{
+    bool reclaimed = false;
+    while (!inFlight_.empty()) {
+        GLsync fence = inFlight_.front().fence;
+        GLenum result = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                         wait ? RING_FENCE_TIMEOUT_NS : 0);
+        if ((result != GL_ALREADY_SIGNALED) && (result != GL_CONDITION_SATISFIED)) {
+            break;
+        }
+        glDeleteSync(fence);
+        inFlight_.pop_front();
+        reclaimed = true;
+        if (wait) {
+            // Only block for as much as the current request needs.
+            break;
+        }
+    }
+    return reclaimed;
+}
+
+bool RingBuffer::Map(GLsizeiptr size, GLsizeiptr alignment, RingAllocation& allocation)
+{
+    if ((buffer_ == 0) || (size <= 0) || (alignment <= 0) || (size >= capacity_)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "RingBuffer", "Map: param error");
+        return false;
+    }
+
+    Reclaim(false);
+    GLintptr offset = Fit(size, alignment);
+    while ((offset < 0) && !inFlight_.empty()) {
+        ++frame_.stalls;
+        if (!Reclaim(true)) {
+            break;
+        }
+        offset = Fit(size, alignment);
+    }
+    if (offset < 0) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "RingBuffer", "Map: frame exceeds ring capacity");
+        return false;
+    }
+
+    stateCache_->BindBuffer(target_, buffer_);
+    void* data = glMapBufferRange(target_, offset, size, RING_MAP_FLAGS);
+    if (data == nullptr) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "RingBuffer", "Map: glMapBufferRange failed");
+        return false;
+    }
+    head_ = offset + size;
+    allocation = {data, offset, size};
+    frame_.frameBytes += size;
+    ++frame_.allocations;
+    return true;
+}
+
+bool RingBuffer::Unmap()
+{
+    stateCache_->BindBuffer(target_, buffer_);
+    return glUnmapBuffer(target_) == GL_TRUE;
+}
+
+GLsizeiptr RingBuffer::InFlightBytes() const
+{
+    if (inFlight_.empty()) {
+        return 0;
+    }
+    GLintptr tail = inFlight_.front().start;
+    return (frameStart_ >= tail) ? (frameStart_ - tail) : (capacity_ - tail + frameStart_);
+}
+
+void RingBuffer::EndFrame()
+{
+    if (head_ != frameStart_) {
+        inFlight_.push_back({frameStart_, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+        frameStart_ = head_;
+    }
+    frame_.inFlightBytes = InFlightBytes();
+    if (frame_.frameBytes > frame_.peakFrameBytes) {
+        frame_.peakFrameBytes = frame_.frameBytes;
+    }
+    lastFrame_ = frame_;
+    GLsizeiptr peak = frame_.peakFrameBytes;
+    frame_ = {};
+    frame_.capacity = capacity_;
+    frame_.peakFrameBytes = peak;
+}
+} // namespace NativeXComponentSample
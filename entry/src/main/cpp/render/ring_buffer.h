@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_RING_BUFFER_H
+#define NATIVE_XCOMPONENT_RING_BUFFER_H
+
+#include <cstdint>
+#include <deque>
+#include <epoxy/gl.h>
+#include "render/gl_state_cache.h"
+
+namespace NativeXComponentSample {
+/**
+ * A mapped region of the ring, valid until Unmap().
+ */
+struct RingAllocation {
+    void* data;
+    GLintptr offset;
+    GLsizeiptr size;
+};
+
+/**
+ * Usage counters of one frame, used to size the ring for a workload.
+ */
+struct RingBufferStats {
+    GLsizeiptr capacity;
+    GLsizeiptr frameBytes;
+    GLsizeiptr peakFrameBytes;
+    GLsizeiptr inFlightBytes;
+    uint32_t allocations;
+    uint32_t wraps;
+    uint32_t stalls;
+};
+
+/**
+ * One GL buffer object sub-allocated front to back for per-frame dynamic data.
+ * Regions are written through unsynchronized, range-invalidating maps and are only
+ * reused once the fence inserted at the end of their frame has signaled.
+ */
+class RingBuffer {
+public:
+    bool Init(GLStateCache* stateCache, GLenum target, GLsizeiptr capacity);
+    void Destroy();
+    bool Map(GLsizeiptr size, GLsizeiptr alignment, RingAllocation& allocation);
+    bool Unmap();
+    void EndFrame();
+    GLuint Buffer() const
+    {
+        return buffer_;
+    }
+    const RingBufferStats& LastFrameStats() const
+    {
+        return lastFrame_;
+    }
+
+private:
+    friend class SelfTest;
+
+    struct FrameRegion {
+        GLintptr start;
+        GLsync fence;
+    };
+
+    GLintptr Fit(GLsizeiptr size, GLsizeiptr alignment);
+    bool Reclaim(bool wait);
+    GLsizeiptr InFlightBytes() const;
+
+    GLStateCache* stateCache_ = nullptr;
+    GLenum target_ = GL_ARRAY_BUFFER;
+    GLuint buffer_ = 0;
+    GLsizeiptr capacity_ = 0;
+    GLintptr head_ = 0;
+    GLintptr frameStart_ = 0;
+    std::deque<FrameRegion> inFlight_;
+    RingBufferStats frame_ = {};
+    RingBufferStats lastFrame_ = {};
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_RING_BUFFER_H
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scene_graph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <hilog/log.h>
+
+#include "../common/common.h"
+
+namespace NativeXComponentSample {
+namespace {
+/**
+ * Transform that leaves positions unchanged.
+ */
+const SceneTransform IDENTITY_TRANSFORM = { 0.0f, 0.0f, 0.0f, 1.0f };
+} // namespace
+
+SceneGraph::SceneGraph()
+{
+    Node root;
+    root.alive = true;
+    root.local = IDENTITY_TRANSFORM;
+    root.world = IDENTITY_TRANSFORM;
+    nodes_.push_back(root);
+}
+
+SceneNodeId SceneGraph::CreateNode(SceneNodeId parent)
+{
+    if (!Valid(parent)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "SceneGraph", "CreateNode: param error");
+        return INVALID_NODE;
+    }
+    SceneNodeId id;
+    if (!freeNodes_.empty()) {
+        id = freeNodes_.back();
+        freeNodes_.pop_back();
+    } else {
+        id = static_cast<SceneNodeId>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    Node& node = nodes_[id];
+    node = Node();
+    node.alive = true;
+    node.parent = parent;
+    node.local = IDENTITY_TRANSFORM;
+    nodes_[parent].children.push_back(id);
+    MarkDirty(id, DIRTY_SUBTREE);
+    return id;
+}
+
+bool SceneGraph::DestroyNode(SceneNodeId id)
+{
+    if ((id == ROOT) || !Valid(id)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "SceneGraph", "DestroyNode: param error");
+        return false;
+    }
+    std::vector<SceneNodeId>& siblings = nodes_[nodes_[id].parent].children;
+    siblings.erase(std::remove(siblings.begin(), siblings.end(), id), siblings.end());
+    DestroySubtree(id);
+    return true;
+}
+
+bool SceneGraph::SetTransform(SceneNodeId id, const SceneTransform& transform)
+{
+    if (!Valid(id)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "SceneGraph", "SetTransform: param error");
+        return false;
+    }
+    Node& node = nodes_[id];
+    if ((node.local.x == transform.x) && (node.local.y == transform.y) &&
+        (node.local.rotation == transform.rotation) && (node.local.scale == transform.scale)) {
+        return true;
+    }
+    node.local = transform;
+    MarkDirty(id, DIRTY_SUBTREE);
+    return true;
+}
+
+bool SceneGraph::SetVisible(SceneNodeId id, bool visible)
+{
+    if (!Valid(id)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "SceneGraph", "SetVisible: param error");
+        return false;
+    }
+    if (nodes_[id].visible != visible) {
+        nodes_[id].visible = visible;
+        MarkDirty(id, DIRTY_SUBTREE);
+    }
+    return true;
+}
+
+bool SceneGraph::SetCacheable(SceneNodeId id, bool cacheable)
+{
+    if (!Valid(id)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "SceneGraph", "SetCacheable: param error");
+        return false;
+    }
+    nodes_[id].cacheable = cacheable;
+    return true;
+}
+
+bool SceneGraph::Cacheable(SceneNodeId id) const
+{
+    for (; Valid(id); id = nodes_[id].parent) {
+        if (nodes_[id].cacheable) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SceneGraph::SetStar(SceneNodeId id, GLfloat radius, uint32_t style)
+{
+    if (!Valid(id) || (radius < 0) || (style >= MAX_DRAW_STYLES)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "SceneGraph", "SetStar: param error");
+        return false;
+    }
+    Node& node = nodes_[id];
+    if (node.hasStar && (node.radius == radius) && (node.style == style)) {
+        return true;
+    }
+    node.hasStar = true;
+    node.radius = radius;
+    node.style = style;
+    MarkDirty(id, DIRTY_CONTENT);
+    return true;
+}
+
+bool SceneGraph::ClearStar(SceneNodeId id)
+{
+    if (!Valid(id)) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "SceneGraph", "ClearStar: param error");
+        return false;
+    }
+    nodes_[id].hasStar = false;
+    ReleaseSlot(nodes_[id]);
+    return true;
+}
+
+bool SceneGraph::Dirty() const
+{
+    return (nodes_[ROOT].dirty != 0) || pending_.countChanged || (pending_.dirtyBegin < pending_.dirtyEnd);
+}
+
+SceneUpdate SceneGraph::Update()
+{
+    Visit(ROOT, IDENTITY_TRANSFORM, true, false);
+
+    SceneUpdate update = pending_;
+    update.dirtyEnd = std::min(update.dirtyEnd, static_cast<uint32_t>(stars_.size()));
+    if (update.dirtyBegin >= update.dirtyEnd) {
+        update.dirtyBegin = 0;
+        update.dirtyEnd = 0;
+    }
+    pending_ = {};
+    return update;
+}
+
+void SceneGraph::MarkDirty(SceneNodeId id, uint8_t flags)
+{
+    nodes_[id].dirty |= flags;
+    // Stop at the first ancestor already flagged; everything above it is flagged too.
+    for (SceneNodeId parent = nodes_[id].parent; parent != INVALID_NODE; parent = nodes_[parent].parent) {
+        if ((nodes_[parent].dirty & DIRTY_CHILDREN) != 0) {
+            break;
+        }
+        nodes_[parent].dirty |= DIRTY_CHILDREN;
+    }
+}
+
+void SceneGraph::Visit(SceneNodeId id, const SceneTransform& parentWorld, bool parentVisible, bool parentChanged)
+{
+    Node& node = nodes_[id];
+    bool changed = parentChanged || ((node.dirty & DIRTY_SUBTREE) != 0);
+    if (!changed && (node.dirty == 0)) {
+        return;
+    }
+    bool visible = parentVisible && node.visible;
+    if (changed) {
+        node.world = Compose(parentWorld, node.local);
+    }
+    if (node.hasStar && (changed || ((node.dirty & DIRTY_CONTENT) != 0))) {
+        WriteStar(id, visible);
+    }
+    bool descend = changed || ((node.dirty & DIRTY_CHILDREN) != 0);
+    node.dirty = 0;
+    if (descend) {
+        for (SceneNodeId child : node.children) {
+            Visit(child, node.world, visible, changed);
+        }
+    }
+}
+
+void SceneGraph::WriteStar(SceneNodeId id, bool visible)
+{
+    Node& node = nodes_[id];
+    if (!visible) {
+        ReleaseSlot(node);
+        return;
+    }
+    if (node.slot == NO_SLOT) {
+        node.slot = static_cast<uint32_t>(stars_.size());
+        stars_.emplace_back();
+        slotOwners_.push_back(id);
+        pending_.countChanged = true;
+    }
+    stars_[node.slot] = { node.world.x, node.world.y, node.world.rotation, node.radius * node.world.scale,
+                          node.style };
+    MarkSlot(node.slot);
+}
+
+void SceneGraph::ReleaseSlot(Node& node)
+{
+    if (node.slot == NO_SLOT) {
+        return;
+    }
+    // Keep the array packed: the last star moves into the freed slot.
+    uint32_t last = static_cast<uint32_t>(stars_.size() - 1);
+    if (node.slot != last) {
+        stars_[node.slot] = stars_[last];
+        slotOwners_[node.slot] = slotOwners_[last];
+        nodes_[slotOwners_[node.slot]].slot = node.slot;
+        MarkSlot(node.slot);
+    }
+    stars_.pop_back();
+    slotOwners_.pop_back();
+    node.slot = NO_SLOT;
+    pending_.countChanged = true;
+}
+
+void SceneGraph::MarkSlot(uint32_t slot)
+{
+    if (pending_.dirtyBegin >= pending_.dirtyEnd) {
+        pending_.dirtyBegin = slot;
+        pending_.dirtyEnd = slot + 1;
+        return;
+    }
+    pending_.dirtyBegin = std::min(pending_.dirtyBegin, slot);
+    pending_.dirtyEnd = std::max(pending_.dirtyEnd, slot + 1);
+}
+
+void SceneGraph::DestroySubtree(SceneNodeId id)
+{
+    for (SceneNodeId child : nodes_[id].children) {
+        DestroySubtree(child);
+    }
+    Node& node = nodes_[id];
+    ReleaseSlot(node);
+    node = Node();
+    freeNodes_.push_back(id);
+}
+
+SceneTransform SceneGraph::Compose(const SceneTransform& parent, const SceneTransform& local)
+{
+    GLfloat c = std::cos(parent.rotation);
+    GLfloat s = std::sin(parent.rotation);
+    return { parent.x + parent.scale * (c * local.x - s * local.y),
+             parent.y + parent.scale * (s * local.x + c * local.y), parent.rotation + local.rotation,
+             parent.scale * local.scale };
+}
+} // namespace NativeXComponentSample
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_SCENE_GRAPH_H
+#define NATIVE_XCOMPONENT_SCENE_GRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <epoxy/gl.h>
+#include <vector>
+
+namespace NativeXComponentSample {
+/**
+ * Per-instance data of the instanced star pass. Positions and radius are in pixels
+ * relative to the surface center, rotation is in radians. style selects the
+ * DrawStyle (color and extra transform) the star is drawn with.
+ */
+struct StarInstance {
+    GLfloat centerX;
+    GLfloat centerY;
+    GLfloat rotation;
+    GLfloat radius;
+    GLuint style;
+};
+
+/**
+ * Number of entries in the style uniform block; star styles index into it.
+ */
+constexpr uint32_t MAX_DRAW_STYLES = 64;
+
+/**
+ * Node handle; stays valid until the node or an ancestor is destroyed.
+ */
+using SceneNodeId = uint32_t;
+
+/**
+ * Similarity transform of a node relative to its parent: rotate by rotation (radians)
+ * and scale uniformly, then translate by (x, y) pixels.
+ */
+struct SceneTransform {
+    GLfloat x;
+    GLfloat y;
+    GLfloat rotation;
+    GLfloat scale;
+};
+
+/**
+ * What Update() changed in the star instance array. Slots in [dirtyBegin, dirtyEnd) were
+ * rewritten; countChanged means instances were added or removed.
+ */
+struct SceneUpdate {
+    bool countChanged;
+    uint32_t dirtyBegin;
+    uint32_t dirtyEnd;
+};
+
+/**
+ * Retained scene owned by the native side. Nodes form a tree under Root(); each has a
+ * local transform, a visibility flag and optionally a star (radius and style). Setters
+ * only mark the node dirty and propagate a child-dirty flag up to the root, so Update()
+ * re-evaluates just the dirty subtrees and rewrites only the star instances whose world
+ * placement, radius or style changed. Visible stars are kept packed in Stars(), ready for
+ * the instanced star pass. Not thread safe; used on the render thread.
+ */
+class SceneGraph {
+public:
+    SceneGraph();
+    SceneNodeId Root() const
+    {
+        return ROOT;
+    }
+    SceneNodeId CreateNode(SceneNodeId parent);
+    // Destroys the node and its whole subtree; the root cannot be destroyed.
+    bool DestroyNode(SceneNodeId id);
+    bool SetTransform(SceneNodeId id, const SceneTransform& transform);
+    bool SetVisible(SceneNodeId id, bool visible);
+    // Gives the node a star of the given radius (scaled by the world transform) and style.
+    bool SetStar(SceneNodeId id, GLfloat radius, uint32_t style);
+    bool ClearStar(SceneNodeId id);
+    // Hints that the node's subtree changes rarely, so the renderer may keep it in an
+    // off-screen layer and only redraw it when it does. Does not dirty the scene.
+    bool SetCacheable(SceneNodeId id, bool cacheable);
+    // True when the node or one of its ancestors is cacheable.
+    bool Cacheable(SceneNodeId id) const;
+    bool Dirty() const;
+    SceneUpdate Update();
+    const std::vector<StarInstance>& Stars() const
+    {
+        return stars_;
+    }
+
+    static constexpr SceneNodeId ROOT = 0;
+    static constexpr SceneNodeId INVALID_NODE = UINT32_MAX;
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+private:
+    enum DirtyFlags : uint8_t {
+        // Transform or visibility changed; the whole subtree is re-evaluated.
+        DIRTY_SUBTREE = 1 << 0,
+        // Star radius or style changed.
+        DIRTY_CONTENT = 1 << 1,
+        // Some descendant is dirty.
+        DIRTY_CHILDREN = 1 << 2,
+    };
+
+    struct Node {
+        bool alive = false;
+        bool visible = true;
+        bool hasStar = false;
+        bool cacheable = false;
+        uint8_t dirty = 0;
+        SceneNodeId parent = INVALID_NODE;
+        std::vector<SceneNodeId> children;
+        SceneTransform local = {};
+        SceneTransform world = {};
+        GLfloat radius = 0;
+        GLuint style = 0;
+        uint32_t slot = NO_SLOT;
+    };
+
+    bool Valid(SceneNodeId id) const
+    {
+        return (id < nodes_.size()) && nodes_[id].alive;
+    }
+    void MarkDirty(SceneNodeId id, uint8_t flags);
+    void Visit(SceneNodeId id, const SceneTransform& parentWorld, bool parentVisible, bool parentChanged);
+    void WriteStar(SceneNodeId id, bool visible);
+    void ReleaseSlot(Node& node);
+    void MarkSlot(uint32_t slot);
+    void DestroySubtree(SceneNodeId id);
+    static SceneTransform Compose(const SceneTransform& parent, const SceneTransform& local);
+
+    std::vector<Node> nodes_;
+    std::vector<SceneNodeId> freeNodes_;
+    std::vector<StarInstance> stars_;
+    // Node owning each star slot, for moving the last star into a freed slot.
+    std::vector<SceneNodeId> slotOwners_;
+    SceneUpdate pending_ = {};
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_SCENE_GRAPH_H
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "self_test.h"
+
+#include <cmath>
+#include <cstring>
+#include <hilog/log.h>
+#include <limits>
+
+#include "../common/common.h"
+#include "damage_tracker.h"
+#include "draw_list.h"
+#include "geometry_batcher.h"
+#include "scene_graph.h"
+
+// Records the failed condition with its line; later checks still run.
+#define SELF_TEST_EXPECT(failures, condition)                                                  \
+    do {                                                                                       \
+        if (!(condition)) {                                                                    \
+            (failures).push_back(std::string(__func__) + ":" + std::to_string(__LINE__) + ": " \
+                                 #condition);                                                  \
+        }                                                                                      \
+    } while (0)
+
+namespace NativeXComponentSample {
+namespace {
+/**
+ * Capacity of the ring used for the placement checks.
+ */
+const GLsizeiptr TEST_RING_CAPACITY = 1000;
+
+/**
+ * Surface size of the damage checks.
+ */
+const GLint TEST_SURFACE_SIZE = 100;
+
+bool SameRect(const DamageRect& a, const DamageRect& b)
+{
+    return (a.x == b.x) && (a.y == b.y) && (a.width == b.width) && (a.height == b.height);
+}
+
+uint16_t HalfOfBits(uint32_t bits)
+{
+    GLfloat value;
+    memcpy(&value, &bits, sizeof(value));
+    return FloatToHalf(value);
+}
+
+bool IsHalfNaN(uint16_t half)
+{
+    return ((half & 0x7C00) == 0x7C00) && ((half & 0x3FF) != 0);
+}
+} // namespace
+
+std::vector<std::string> SelfTest::Run(const std::string& group)
+{
+    std::vector<std::string> failures;
+    bool all = group.empty();
+    bool known = all;
+    if (all || (group == "drawKeys")) {
+        DrawKeys(failures);
+        known = true;
+    }
+    if (all || (group == "ringBuffer")) {
+        RingBufferWrap(failures);
+        known = true;
+    }
+    if (all || (group == "floatToHalf")) {
+        FloatToHalfEdges(failures);
+        known = true;
+    }
+    if (all || (group == "sceneGraph")) {
+        SceneDirty(failures);
+        known = true;
+    }
+    if (all || (group == "damage")) {
+        DamageResolve(failures);
+        known = true;
+    }
+    if (!known) {
+        failures.push_back("unknown group " + group);
+    }
+    for (const std::string& failure : failures) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, LOG_PRINT_DOMAIN, "SelfTest", "%{public}s", failure.c_str());
+    }
+    return failures;
+}
+
+void SelfTest::DrawKeys(std::vector<std::string>& failures)
+{
+    // Smaller depth is nearer. Opaque draws go front to back, topmost layer first.
+    SELF_TEST_EXPECT(failures, DrawList::MakeKey(1, 1, 0, false, -0.9f) < DrawList::MakeKey(1, 1, 0, false, -0.1f));
+    SELF_TEST_EXPECT(failures, DrawList::MakeKey(1, 1, 0, false, -0.5f) < DrawList::MakeKey(1, 1, 0, false, 0.5f));
+    SELF_TEST_EXPECT(failures, DrawList::MakeKey(2, 1, 0, false, 0.0f) < DrawList::MakeKey(1, 1, 0, false, -1.0f));
+    // Within a layer, state groups before depth.
+    SELF_TEST_EXPECT(failures, DrawList::MakeKey(1, 1, 0, false, 0.0f) < DrawList::MakeKey(1, 2, 0, false, -1.0f));
+    // Translucent draws come after every opaque one, bottom layer first, back to front.
+    SELF_TEST_EXPECT(failures, DrawList::MakeKey(0, 1, 0, false, 0.0f) < DrawList::MakeKey(0, 1, 0, true, 0.0f));
+    SELF_TEST_EXPECT(failures, DrawList::MakeKey(1, 1, 0, true, -0.1f) < DrawList::MakeKey(1, 1, 0, true, -0.9f));
+    SELF_TEST_EXPECT(failures, DrawList::MakeKey(1, 1, 0, true, -0.1f) < DrawList::MakeKey(2, 1, 0, true, -0.9f));
+
+    // The radix sort orders by key and keeps equal keys in submission order.
+    const uint64_t keys[] = {
+        DrawList::MakeKey(1, 1, 0, true, -0.9f), DrawList::MakeKey(1, 1, 0, false, -0.1f),
+        DrawList::MakeKey(1, 1, 0, true, -0.1f), DrawList::MakeKey(1, 1, 0, false, -0.9f),
+        DrawList::MakeKey(1, 1, 0, false, -0.1f),
+    };
+    const uint32_t expected[] = { 3, 1, 4, 2, 0 };
+    DrawList list;
+    DrawCommand command = {};
+    for (uint64_t key : keys) {
+        list.Add(key, command);
+    }
+    list.Sort();
+    SELF_TEST_EXPECT(failures, list.items_.size() == sizeof(expected) / sizeof(expected[0]));
+    for (size_t i = 0; (i < list.items_.size()) && (i < sizeof(expected) / sizeof(expected[0])); ++i) {
+        SELF_TEST_EXPECT(failures, list.items_[i].command == expected[i]);
+    }
+}
+
+GLintptr SelfTest::Allocate(RingBuffer& ring, GLsizeiptr size, GLsizeiptr alignment)
+{
+    GLintptr offset = ring.Fit(size, alignment);
+    if (offset >= 0) {
+        ring.head_ = offset + size;
+    }
+    return offset;
+}
+
+void SelfTest::SubmitFrame(RingBuffer& ring)
+{
+    // No fence: retiring a frame is popping it, as Reclaim() does once the fence signaled.
+    if (ring.head_ != ring.frameStart_) {
+        ring.inFlight_.push_back({ ring.frameStart_, nullptr });
+        ring.frameStart_ = ring.head_;
+    }
+}
+
+void SelfTest::RingBufferWrap(std::vector<std::string>& failures)
+{
+    RingBuffer ring;
+    ring.capacity_ = TEST_RING_CAPACITY;
+
+    SELF_TEST_EXPECT(failures, Allocate(ring, 600, 4) == 0);
+    SubmitFrame(ring);
+    // Aligned up from the previous frame's end.
+    SELF_TEST_EXPECT(failures, Allocate(ring, 298, 4) == 600);
+    SELF_TEST_EXPECT(failures, Allocate(ring, 1, 4) == 900);
+    SubmitFrame(ring);
+    // No room at the end, and the front is still in flight.
+    SELF_TEST_EXPECT(failures, Allocate(ring, 200, 4) < 0);
+
+    // Once the first frame is reclaimed the request wraps to the front.
+    ring.inFlight_.pop_front();
+    SELF_TEST_EXPECT(failures, Allocate(ring, 200, 4) == 0);
+    SELF_TEST_EXPECT(failures, ring.frame_.wraps == 1);
+    // Behind the tail, a region must end strictly before it so a full ring never looks empty.
+    SELF_TEST_EXPECT(failures, Allocate(ring, 400, 4) < 0);
+    SELF_TEST_EXPECT(failures, Allocate(ring, 396, 4) == 200);
+    SubmitFrame(ring);
+
+    // Everything reclaimed: placement restarts at the front.
+    ring.inFlight_.clear();
+    SELF_TEST_EXPECT(failures, Allocate(ring, 100, 4) == 0);
+}
+
+void SelfTest::FloatToHalfEdges(std::vector<std::string>& failures)
+{
+    const GLfloat infinity = std::numeric_limits<GLfloat>::infinity();
+    SELF_TEST_EXPECT(failures, FloatToHalf(0.0f) == 0x0000);
+    SELF_TEST_EXPECT(failures, FloatToHalf(-0.0f) == 0x8000);
+    SELF_TEST_EXPECT(failures, FloatToHalf(1.0f) == 0x3C00);
+    SELF_TEST_EXPECT(failures, FloatToHalf(-2.0f) == 0xC000);
+    SELF_TEST_EXPECT(failures, FloatToHalf(1.0f + 1.0f / 1024) == 0x3C01);
+    // Largest half, and the first value that rounds past it.
+    SELF_TEST_EXPECT(failures, FloatToHalf(65504.0f) == 0x7BFF);
+    SELF_TEST_EXPECT(failures, FloatToHalf(65520.0f) == 0x7C00);
+    SELF_TEST_EXPECT(failures, FloatToHalf(1.0e6f) == 0x7C00);
+    SELF_TEST_EXPECT(failures, FloatToHalf(-1.0e6f) == 0xFC00);
+    SELF_TEST_EXPECT(failures, FloatToHalf(infinity) == 0x7C00);
+    SELF_TEST_EXPECT(failures, FloatToHalf(-infinity) == 0xFC00);
+    // Subnormal halves are flushed.
+    SELF_TEST_EXPECT(failures, FloatToHalf(1.0e-8f) == 0x0000);
+    SELF_TEST_EXPECT(failures, FloatToHalf(-1.0e-8f) == 0x8000);
+    SELF_TEST_EXPECT(failures, IsHalfNaN(FloatToHalf(std::numeric_limits<GLfloat>::quiet_NaN())));
+    // Payload only in bits the conversion drops; must not turn into an infinity.
+    SELF_TEST_EXPECT(failures, IsHalfNaN(HalfOfBits(0x7F800001)));
+    SELF_TEST_EXPECT(failures, IsHalfNaN(HalfOfBits(0xFF800001)));
+}
+
+void SelfTest::SceneDirty(std::vector<std::string>& failures)
+{
+    SceneGraph scene;
+    SceneNodeId group = scene.CreateNode(scene.Root());
+    SceneNodeId first = scene.CreateNode(group);
+    SceneNodeId second = scene.CreateNode(group);
+    scene.SetTransform(group, { 10.0f, 0.0f, 0.0f, 2.0f });
+    scene.SetStar(first, 1.0f, 0);
+    scene.SetStar(second, 2.0f, 1);
+    SELF_TEST_EXPECT(failures, scene.Dirty());
+    SceneUpdate update = scene.Update();
+    SELF_TEST_EXPECT(failures, update.countChanged);
+    SELF_TEST_EXPECT(failures, scene.Stars().size() == 2);
+    SELF_TEST_EXPECT(failures, !scene.Dirty());
+    // Stars inherit the group transform.
+    uint32_t secondSlot = (scene.Stars()[0].style == 1) ? 0 : 1;
+    SELF_TEST_EXPECT(failures, scene.Stars()[secondSlot].radius == 4.0f);
+    SELF_TEST_EXPECT(failures, scene.Stars()[secondSlot].centerX == 10.0f);
+
+    // A clean scene rewrites nothing.
+    update = scene.Update();
+    SELF_TEST_EXPECT(failures, !update.countChanged && (update.dirtyBegin == update.dirtyEnd));
+
+    // A leaf change only rewrites the leaf's slot.
+    scene.SetTransform(second, { 5.0f, 0.0f, 0.0f, 1.0f });
+    SELF_TEST_EXPECT(failures, scene.Dirty());
+    update = scene.Update();
+    SELF_TEST_EXPECT(failures, !update.countChanged);
+    SELF_TEST_EXPECT(failures, (update.dirtyBegin == secondSlot) && (update.dirtyEnd == secondSlot + 1));
+    SELF_TEST_EXPECT(failures, scene.Stars()[secondSlot].centerX == 20.0f);
+
+    // A group change rewrites the whole subtree.
+    scene.SetTransform(group, { 0.0f, 0.0f, 0.0f, 1.0f });
+    update = scene.Update();
+    SELF_TEST_EXPECT(failures, (update.dirtyBegin == 0) && (update.dirtyEnd == 2));
+    SELF_TEST_EXPECT(failures, scene.Stars()[secondSlot].centerX == 5.0f);
+
+    // Hiding a star keeps the array packed; the survivor moves into the freed slot.
+    scene.SetVisible(secondSlot == 0 ? second : first, false);
+    update = scene.Update();
+    SELF_TEST_EXPECT(failures, update.countChanged);
+    SELF_TEST_EXPECT(failures, scene.Stars().size() == 1);
+    SELF_TEST_EXPECT(failures, scene.Stars()[0].style == ((secondSlot == 0) ? 0u : 1u));
+
+    // Destroying the group removes its whole subtree.
+    SELF_TEST_EXPECT(failures, scene.DestroyNode(group));
+    SELF_TEST_EXPECT(failures, scene.Dirty());
+    update = scene.Update();
+    SELF_TEST_EXPECT(failures, update.countChanged && scene.Stars().empty());
+    SELF_TEST_EXPECT(failures, !scene.SetVisible(first, true));
+}
+
+void SelfTest::DamageResolve(std::vector<std::string>& failures)
+{
+    const DamageRect full = { 0, 0, TEST_SURFACE_SIZE, TEST_SURFACE_SIZE };
+    DamageTracker damage;
+    damage.Reset(TEST_SURFACE_SIZE, TEST_SURFACE_SIZE);
+    SELF_TEST_EXPECT(failures, SameRect(damage.Resolve(1), full));
+    damage.EndFrame();
+
+    damage.Add({ 10, 10, 5, 5 });
+    SELF_TEST_EXPECT(failures, SameRect(damage.Resolve(1), { 10, 10, 5, 5 }));
+    // Age 2 also repaints the previous frame, which was full.
+    SELF_TEST_EXPECT(failures, SameRect(damage.Resolve(2), full));
+    damage.EndFrame();
+
+    damage.Add({ 50, 50, 10, 10 });
+    SELF_TEST_EXPECT(failures, SameRect(damage.Resolve(1), { 50, 50, 10, 10 }));
+    SELF_TEST_EXPECT(failures, SameRect(damage.Resolve(2), { 10, 10, 50, 50 }));
+    SELF_TEST_EXPECT(failures, SameRect(damage.Resolve(3), full));
+    // Undefined contents, or older than the history: everything.
+    SELF_TEST_EXPECT(failures, SameRect(damage.Resolve(0), full));
+    SELF_TEST_EXPECT(failures, SameRect(damage.Resolve(4), full));
+    damage.EndFrame();
+
+    // Damage is clipped to the surface.
+    damage.Add({ -5, -5, 10, 10 });
+    SELF_TEST_EXPECT(failures, SameRect(damage.Resolve(1), { 0, 0, 5, 5 }));
+    damage.Add({ 200, 200, 10, 10 });
+    SELF_TEST_EXPECT(failures, SameRect(damage.Resolve(1), { 0, 0, 5, 5 }));
+}
+} // namespace NativeXComponentSample
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_SELF_TEST_H
+#define NATIVE_XCOMPONENT_SELF_TEST_H
+
+#include <epoxy/gl.h>
+#include <string>
+#include <vector>
+#include "render/ring_buffer.h"
+
+namespace NativeXComponentSample {
+/**
+ * Checks of the renderer's CPU-side logic: draw key ordering, ring buffer placement, half
+ * float conversion, scene dirty tracking and buffer age damage. Nothing here touches GL,
+ * so it runs on any thread; the ohosTest suite calls it through runSelfTests().
+ */
+class SelfTest {
+public:
+    // Runs the named group ("drawKeys", "ringBuffer", "floatToHalf", "sceneGraph",
+    // "damage"), or all of them for an empty name. Returns the failed checks.
+    static std::vector<std::string> Run(const std::string& group);
+
+private:
+    static void DrawKeys(std::vector<std::string>& failures);
+    static void RingBufferWrap(std::vector<std::string>& failures);
+    static void FloatToHalfEdges(std::vector<std::string>& failures);
+    static void SceneDirty(std::vector<std::string>& failures);
+    static void DamageResolve(std::vector<std::string>& failures);
+    // What Map() and EndFrame() do to the ring's bookkeeping, without mapping or fencing.
+    static GLintptr Allocate(RingBuffer& ring, GLsizeiptr size, GLsizeiptr alignment);
+    static void SubmitFrame(RingBuffer& ring);
+};
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_SELF_TEST_H
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NATIVE_XCOMPONENT_SHAPE_LIBRARY_H
+#define NATIVE_XCOMPONENT_SHAPE_LIBRARY_H
+
+#include <array>
+#include <cstddef>
+#include <epoxy/gl.h>
+#include <ratio>
+
+namespace NativeXComponentSample {
+namespace ShapeMath {
+/**
+ * Pi with double precision, usable in constant expressions.
+ */
+constexpr double PI = 3.14159265358979323846;
+
+/**
+ * Taylor terms evaluated by Sin/Cos; enough for float precision on [-pi, pi].
+ */
+constexpr int TAYLOR_TERMS = 12;
+
+constexpr double WrapAngle(double radians)
+{
+    while (radians > PI) {
+        radians -= 2 * PI;
+    }
+    while (radians < -PI) {
+        radians += 2 * PI;
+    }
+    return radians;
+}
+
+// std::sin/std::cos are not constexpr before C++26.
+constexpr double Sin(double radians)
+{
+    double x = WrapAngle(radians);
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < TAYLOR_TERMS; ++n) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double Cos(double radians)
+{
+    double x = WrapAngle(radians);
+    double term = 1;
+    double sum = 1;
+    for (int n = 1; n < TAYLOR_TERMS; ++n) {
+        term *= -x * x / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+} // namespace ShapeMath
+
+/**
+ * Type-erased view of a generated shape, pointing into static storage.
+ */
+struct ShapeMesh {
+    const GLfloat* vertices;
+    GLsizei vertexCount;
+    const GLushort* indices;
+    GLsizei indexCount;
+};
+
+/**
+ * Unit-space vertex (x, y pairs) and triangle-list index tables of one shape.
+ */
+template <size_t VertexCount, size_t IndexCount>
+struct ShapeTables {
+    static constexpr size_t VERTEX_COUNT = VertexCount;
+    static constexpr size_t INDEX_COUNT = IndexCount;
+
+    std::array<GLfloat, VertexCount * 2> vertices;
+    std::array<GLushort, IndexCount> indices;
+};
+
+/**
+ * Regular N-gon of circumradius 1 around the origin, first corner pointing up (+y).
+ * Vertex 0 is the center, followed by the N corners counter-clockwise.
+ */
+template <size_t N>
+constexpr ShapeTables<N + 1, N * 3> BuildRegularPolygon()
+{
+    ShapeTables<N + 1, N * 3> tables = {};
+    for (size_t i = 0; i < N; ++i) {
+        double angle = ShapeMath::PI / 2 + 2 * ShapeMath::PI * i / N;
+        tables.vertices[(i + 1) * 2] = static_cast<GLfloat>(ShapeMath::Cos(angle));
+        tables.vertices[(i + 1) * 2 + 1] = static_cast<GLfloat>(ShapeMath::Sin(angle));
+        tables.indices[i * 3] = 0;
+        tables.indices[i * 3 + 1] = static_cast<GLushort>(i + 1);
+        tables.indices[i * 3 + 2] = static_cast<GLushort>((i + 1) % N + 1);
+    }
+    return tables;
+}
+
+/**
+ * Star with N points of outer radius 1 and inner radius `inner`, first point up (+y).
+ * Vertex 0 is the center, followed by alternating outer and inner corners counter-clockwise.
+ */
+template <size_t N>
+constexpr ShapeTables<2 * N + 1, 2 * N * 3> BuildRegularStar(double inner)
+{
+    ShapeTables<2 * N + 1, 2 * N * 3> tables = {};
+    for (size_t i = 0; i < 2 * N; ++i) {
+        double radius = (i % 2 == 0) ? 1.0 : inner;
+        double angle = ShapeMath::PI / 2 + ShapeMath::PI * i / N;
+        tables.vertices[(i + 1) * 2] = static_cast<GLfloat>(radius * ShapeMath::Cos(angle));
+        tables.vertices[(i + 1) * 2 + 1] = static_cast<GLfloat>(radius * ShapeMath::Sin(angle));
+        tables.indices[i * 3] = 0;
+        tables.indices[i * 3 + 1] = static_cast<GLushort>(i + 1);
+        tables.indices[i * 3 + 2] = static_cast<GLushort>((i + 1) % (2 * N) + 1);
+    }
+    return tables;
+}
+
+/**
+ * Compile-time tables of a regular N-gon, see BuildRegularPolygon().
+ */
+template <size_t N>
+struct RegularPolygon {
+    static_assert(N >= 3, "a polygon needs at least three corners");
+    using Tables = ShapeTables<N + 1, N * 3>;
+
+    static constexpr Tables TABLES = BuildRegularPolygon<N>();
+
+    static ShapeMesh Mesh()
+    {
+        return { TABLES.vertices.data(), static_cast<GLsizei>(Tables::VERTEX_COUNT), TABLES.indices.data(),
+                 static_cast<GLsizei>(Tables::INDEX_COUNT) };
+    }
+};
+
+/**
+ * Compile-time tables of an N-pointed star whose inner radius is InnerRatio (a std::ratio),
+ * see BuildRegularStar(). std::ratio<382, 1000> gives the classic pentagram.
+ */
+template <size_t N, typename InnerRatio>
+struct RegularStar {
+    static_assert(N >= 2, "a star needs at least two points");
+    static_assert((InnerRatio::num > 0) && (InnerRatio::num <= InnerRatio::den),
+                  "inner radius must be in (0, 1]");
+    using Tables = ShapeTables<2 * N + 1, 2 * N * 3>;
+
+    static constexpr Tables TABLES =
+        BuildRegularStar<N>(static_cast<double>(InnerRatio::num) / InnerRatio::den);
+
+    static ShapeMesh Mesh()
+    {
+        return { TABLES.vertices.data(), static_cast<GLsizei>(Tables::VERTEX_COUNT), TABLES.indices.data(),
+                 static_cast<GLsizei>(Tables::INDEX_COUNT) };
+    }
+};
+
+/**
+ * Five-pointed star drawn by the sample.
+ */
+using Pentagram = RegularStar<5, std::ratio<382, 1000>>;
+} // namespace NativeXComponentSample
+#endif // NATIVE_XCOMPONENT_SHAPE_LIBRARY_H
@@ -18,6 +18,14 @@ type XComponentContextStatus = {
   hasDraw: boolean,
   hasChangeColor: boolean
 };
+type ShapeBenchmark = {
+  format: string,
+  bytesPerFrame: number,
+  msPerFrame: number
+};
 export const createNativeNode: (content: NodeContent, tag: string) => void;
 export const getStatus: () => XComponentContextStatus;
-export const drawPattern: () => void;
\ No newline at end of file
+export const drawPattern: (id?: string) => void;
+export const setCacheDir: (dir: string) => void;
+export const benchmarkShapes: (frames?: number, shapes?: number) => Promise<ShapeBenchmark[]>;
+export const runSelfTests: (group?: string) => string[];
\ No newline at end of file